@@ -0,0 +1,130 @@
+#include "../src/mpc_tracker/other_uavs.h"
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace mrs_uav_trackers::mpc_tracker;
+
+// the collision check of the MpcTracker against 1 to 200 other UAVs, as it runs every MPC iteration
+// the UAVs fly straight at random positions of a 500 m x 500 m area, the other UAVs are culled by the boxes of the trajectories first,
+// the check without culling tests every UAV in detail
+
+namespace
+{
+
+const int    horizon_len = 40;
+const double dt          = 0.2;  // of the predicted trajectories
+const double radius      = 5.0;  // the avoidance thresholds of the default config
+const double height      = 2.0;
+const double area        = 500.0;
+const int    n_ticks     = 20000;
+
+using steady_clock = std::chrono::steady_clock;
+
+// a straight flight with the given speed
+void flyStraight(mpc_positions_t& positions, const Eigen::Vector3d& start, const Eigen::Vector3d& velocity) {
+
+  for (int i = 0; i < positions.rows(); i++) {
+    positions.row(i) = (start + i * dt * velocity).transpose().array();
+  }
+}
+
+// the loop of MpcTracker::checkTrajectoryForCollisions() without the avoidance logic, returns the first colliding sample (INT_MAX when
+// none) and counts the UAVs tested in detail
+int checkCollisions(const mpc_positions_t& positions, const std::vector<OtherUav_t>& other_uavs, const bool cull, int& n_tested) {
+
+  const Eigen::AlignedBox3d box = inflatedBox(positions, radius, height);
+
+  mpc_horizon_array_t collision, collision_inflated;
+
+  int first_collision_index = INT_MAX;
+
+  for (const OtherUav_t& other_uav : other_uavs) {
+
+    const OtherUavSummary_t summary = other_uav.summary.load();
+
+    if (summary.stamp.isZero() || (cull && !box.intersects(summary.box()))) {
+      continue;
+    }
+
+    const OtherUavTrajectory_t other_uav_trajectory = other_uav.trajectory.load();
+
+    collisionMargins(positions, other_uav_trajectory, radius, height, collision, collision_inflated);
+
+    n_tested++;
+
+    for (int v = 0; v < other_uav_trajectory.n_points; v++) {
+      if (collision_inflated(v) < 0) {
+        first_collision_index = std::min(first_collision_index, v);
+        break;
+      }
+    }
+  }
+
+  return first_collision_index;
+}
+
+}  // namespace
+
+int main(void) {
+
+  std::mt19937                           generator(0);
+  std::uniform_real_distribution<double> position(-area / 2, area / 2);
+  std::uniform_real_distribution<double> altitude(2.0, 20.0);
+  std::uniform_real_distribution<double> speed(-5.0, 5.0);
+
+  // ours starts in the middle
+  mpc_positions_t positions(horizon_len, 3);
+  flyStraight(positions, Eigen::Vector3d(0, 0, 10), Eigen::Vector3d(2, 1, 0));
+
+  printf("%d MPC iterations, horizon of %d samples\n\n", n_ticks, horizon_len);
+  printf("%6s %16s %16s %10s\n", "UAVs", "culled [us]", "all [us]", "tested");
+
+  for (const int n_uavs : {1, 2, 5, 10, 20, 50, 100, 200}) {
+
+    std::vector<OtherUav_t> other_uavs(n_uavs);
+
+    for (int i = 0; i < n_uavs; i++) {
+
+      OtherUavTrajectory_t trajectory;
+
+      mpc_positions_t other_positions(horizon_len, 3);
+      flyStraight(other_positions, Eigen::Vector3d(position(generator), position(generator), altitude(generator)),
+                  Eigen::Vector3d(speed(generator), speed(generator), 0));
+
+      trajectory.summary.stamp = ros::Time(1);
+      trajectory.summary.setBox(Eigen::AlignedBox3d(other_positions.colwise().minCoeff().transpose().matrix(),
+                                                    other_positions.colwise().maxCoeff().transpose().matrix()));
+
+      trajectory.positions.map().topRows(horizon_len) = other_positions;
+      trajectory.n_points                             = horizon_len;
+      trajectory.priority                             = i;
+      trajectory.collision_avoidance                  = true;
+
+      other_uavs[i].trajectory.store(trajectory);
+      other_uavs[i].summary.store(trajectory.summary);
+    }
+
+    double time[2];
+    int    n_tested[2] = {0, 0};
+    int    checksum    = 0;
+
+    for (const bool cull : {true, false}) {
+
+      const auto start = steady_clock::now();
+
+      for (int t = 0; t < n_ticks; t++) {
+        checksum += checkCollisions(positions, other_uavs, cull, n_tested[cull ? 0 : 1]) == INT_MAX;
+      }
+
+      time[cull ? 0 : 1] = std::chrono::duration<double, std::micro>(steady_clock::now() - start).count() / n_ticks;
+    }
+
+    printf("%6d %16.3f %16.3f %10d%s\n", n_uavs, time[0], time[1], n_tested[0] / n_ticks, checksum == 2 * n_ticks ? "" : " (collision)");
+  }
+
+  return 0;
+}
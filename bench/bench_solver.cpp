@@ -0,0 +1,82 @@
+#include <mpc_tracker_solver.h>
+
+#include "../test/solver/closed_loop.h"
+
+#ifdef MPC_TRACKER_BENCH_REFERENCE_SOLVER
+#include "../test/solver/reference_solver.h"
+#endif
+
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+using namespace mrs_uav_trackers::test;
+
+// the solve time of the in-tree solver of one axis, flying the steps of the solver tests in closed loop
+// the prebuilt libMpcTrackerSolver.so is measured alongside when the bench is built with MPC_TRACKER_REFERENCE_SOLVER
+
+namespace
+{
+
+const int n_repeats = 5;  // of every closed loop, the times are averaged, the longest solve is the longest over all of them
+
+ClosedLoopResult_t repeat(std::function<ClosedLoopResult_t(void)> run) {
+
+  ClosedLoopResult_t total;
+
+  for (int i = 0; i < n_repeats; i++) {
+
+    const ClosedLoopResult_t result = run();
+
+    total.mean_solve_time += result.mean_solve_time / n_repeats;
+    total.max_solve_time = std::max(total.max_solve_time, result.max_solve_time);
+  }
+
+  return total;
+}
+
+void print(const char* name, const int max_iters, const ClosedLoopResult_t& result) {
+  printf("  %-10s %5d %16.1f %16.1f\n", name, max_iters, 1e6 * result.mean_solve_time, 1e6 * result.max_solve_time);
+}
+
+}  // namespace
+
+int main(void) {
+
+  const std::vector<std::array<double, 4>> limit_sets = {{2.0, 2.0, 20.0, 20.0}, {1.0, 1.0, 10.0, 10.0}, {5.0, 3.0, 30.0, 40.0}};
+
+  for (const auto& limits : limit_sets) {
+
+    ClosedLoopParams_t params;
+    params.max_speed = limits[0];
+    params.max_acc   = limits[1];
+    params.max_jerk  = limits[2];
+    params.max_snap  = limits[3];
+
+    std::vector<double> dts(params.horizon_len, params.dt2);
+    dts[0] = params.dt1;
+
+    printf("10 m step, limits v %.0f / a %.0f / j %.0f / s %.0f, %d solves\n", params.max_speed, params.max_acc, params.max_jerk, params.max_snap,
+           params.n_steps);
+    printf("  %-10s %5s %16s %16s\n", "solver", "iters", "mean [us]", "longest [us]");
+
+    for (const int max_iters : {25, 200}) {
+
+      const ClosedLoopResult_t result = repeat([&]() {
+        mrs_mpc_solvers::mpc_tracker::Solver solver("MpcTrackerBench", false, max_iters, {5000, 0, 0, 0}, dts, 0);
+        return runClosedLoop(solver, params);
+      });
+
+      print("in-tree", max_iters, result);
+    }
+
+#ifdef MPC_TRACKER_BENCH_REFERENCE_SOLVER
+    print("prebuilt", 25, repeat([&]() { return runClosedLoopReference(params, 25); }));
+#endif
+
+    printf("\n");
+  }
+
+  return 0;
+}
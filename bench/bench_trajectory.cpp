@@ -0,0 +1,255 @@
+#include "../src/mpc_tracker/trajectory_snapshot.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace mrs_uav_trackers::mpc_tracker;
+
+// the operations of the MpcTracker on a long trajectory: loading it, resampling it on the horizon every MPC iteration, switching the
+// odometry and splicing a tail to it
+// the interleaved snapshot is compared with four separate vectors of x, y, z and heading, which is how the trajectory was stored before
+
+namespace
+{
+
+const int    n_points      = 100000;
+const int    n_splice      = 1000;
+const double dt1           = 0.01;  // the MPC period
+const double dt2           = 0.2;   // the spacing of the rest of the horizon
+const double trajectory_dt = 0.2;
+const int    horizon_len   = 40;
+
+using steady_clock = std::chrono::steady_clock;
+
+double elapsedUs(const steady_clock::time_point& start) {
+  return std::chrono::duration<double, std::micro>(steady_clock::now() - start).count();
+}
+
+// a random walk, so the points are not constant
+std::vector<mrs_msgs::Reference> makePoints(const int n) {
+
+  std::mt19937                     generator(0);
+  std::normal_distribution<double> step(0.0, 0.1);
+
+  std::vector<mrs_msgs::Reference> points(n);
+
+  for (int i = 1; i < n; i++) {
+    points[i].position.x = points[i - 1].position.x + step(generator);
+    points[i].position.y = points[i - 1].position.y + step(generator);
+    points[i].position.z = points[i - 1].position.z + step(generator);
+    points[i].heading    = points[i - 1].heading + step(generator);
+  }
+
+  return points;
+}
+
+/* the layout before: four vectors //{ */
+
+struct FourVectors_t
+{
+  Eigen::VectorXd x, y, z, heading;
+};
+
+FourVectors_t loadFourVectors(const std::vector<mrs_msgs::Reference>& points) {
+
+  FourVectors_t trajectory;
+
+  trajectory.x.resize(points.size());
+  trajectory.y.resize(points.size());
+  trajectory.z.resize(points.size());
+  trajectory.heading.resize(points.size());
+
+  for (size_t i = 0; i < points.size(); i++) {
+    trajectory.x(i)       = points[i].position.x;
+    trajectory.y(i)       = points[i].position.y;
+    trajectory.z(i)       = points[i].position.z;
+    trajectory.heading(i) = points[i].heading;
+  }
+
+  return trajectory;
+}
+
+void offsetFourVectors(FourVectors_t& trajectory, const Eigen::Matrix2d& rotation, const Eigen::Vector2d& old_position, const Eigen::Vector2d& new_position,
+                       const Eigen::Vector2d& shift) {
+
+  for (int i = 0; i < trajectory.x.size(); i++) {
+
+    const Eigen::Vector2d position = rotation * (Eigen::Vector2d(trajectory.x(i), trajectory.y(i)) - old_position) + new_position;
+
+    trajectory.x(i) = position(0);
+    trajectory.y(i) = position(1);
+    trajectory.z(i) += shift(0);
+    trajectory.heading(i) += shift(1);
+  }
+}
+
+void resampleFourVectors(const FourVectors_t& trajectory, const HorizonStencil_t& stencil, const int idx, mpc_horizon_t& des_x, mpc_horizon_t& des_y,
+                         mpc_horizon_t& des_z, mpc_horizon_t& des_heading) {
+
+  const int last_idx = int(trajectory.x.size()) - 1;
+
+  des_x.resize(horizon_len);
+  des_y.resize(horizon_len);
+  des_z.resize(horizon_len);
+  des_heading.resize(horizon_len);
+
+  for (int i = 0; i < horizon_len; i++) {
+
+    const int    first  = std::min(idx + stencil.offset(i), last_idx);
+    const int    second = std::min(first + 1, last_idx);
+    const double coeff  = stencil.coeff(i);
+
+    des_x(i)       = (1 - coeff) * trajectory.x(first) + coeff * trajectory.x(second);
+    des_y(i)       = (1 - coeff) * trajectory.y(first) + coeff * trajectory.y(second);
+    des_z(i)       = (1 - coeff) * trajectory.z(first) + coeff * trajectory.z(second);
+    des_heading(i) = mrs_lib::geometry::sradians::interp(trajectory.heading(first), trajectory.heading(second), coeff);
+  }
+}
+
+//}
+
+}  // namespace
+
+int main(void) {
+
+  const std::vector<mrs_msgs::Reference> points = makePoints(n_points);
+  const std::vector<mrs_msgs::Reference> tail   = makePoints(n_splice);
+
+  // the samples of the horizon as the MpcTracker places them, the first one dt1 ahead
+  std::vector<double> sample_time(horizon_len);
+
+  for (int i = 0; i < horizon_len; i++) {
+    sample_time[i] = (i == 0 ? 0 : sample_time[i - 1]) + (i == 0 ? dt1 : dt2);
+  }
+
+  const int n_stencils = int(std::ceil(trajectory_dt / dt1)) + 1;
+
+  auto stencils = std::make_shared<std::vector<HorizonStencil_t>>();
+
+  for (int i = 0; i < n_stencils; i++) {
+    stencils->push_back(makeHorizonStencil(sample_time, i * dt1, trajectory_dt));
+  }
+
+  // the whole trajectory is flown, one resampling per MPC iteration
+  const int n_ticks = int((n_points - 1) * trajectory_dt / dt1);
+
+  const Eigen::Matrix2d rotation = Eigen::Rotation2D<double>(0.3).toRotationMatrix();
+  const Eigen::Vector2d old_position(1, 2);
+  const Eigen::Vector2d new_position(3, 4);
+  const Eigen::Vector2d shift(0.5, 0.3);
+
+  mpc_horizon_t des_x, des_y, des_z, des_heading;
+
+  double checksum = 0;
+
+  printf("%d points, %d MPC iterations over the trajectory, horizon of %d samples\n\n", n_points, n_ticks, horizon_len);
+
+  /* the snapshot //{ */
+
+  {
+    auto start = steady_clock::now();
+
+    auto snapshot = std::make_shared<TrajectorySnapshot_t>();
+
+    snapshot->dt       = trajectory_dt;
+    snapshot->stencils = stencils;
+    snapshot->append(points, 0, nullptr);
+
+    const double load_us = elapsedUs(start);
+
+    int cursor = 0;
+
+    start = steady_clock::now();
+
+    for (int t = 0; t < n_ticks; t++) {
+      resampleTrajectory(*snapshot, sample_time, dt1, t * dt1, cursor, des_x, des_y, des_z, des_heading);
+      checksum += des_x(0);
+    }
+
+    const double resample_us = elapsedUs(start) / n_ticks;
+
+    // the odometry switch composes the frame, the points are not touched
+    start = steady_clock::now();
+
+    auto switched = std::make_shared<TrajectorySnapshot_t>(*snapshot);
+
+    TrajectoryFrame_t odometry_switch;
+
+    odometry_switch.rotation    = rotation;
+    odometry_switch.translation = new_position - rotation * old_position;
+    odometry_switch.shift       = shift;
+
+    switched->frame = switched->frame.then(odometry_switch);
+
+    const double offset_us = elapsedUs(start);
+
+    start = steady_clock::now();
+
+    for (int t = 0; t < n_ticks; t++) {
+      resampleTrajectory(*switched, sample_time, dt1, t * dt1, cursor, des_x, des_y, des_z, des_heading);
+      checksum += des_x(0);
+    }
+
+    const double resample_switched_us = elapsedUs(start) / n_ticks;
+
+    // the tail replaces the second half, the blocks of the first half are shared
+    start = steady_clock::now();
+
+    auto spliced = std::make_shared<TrajectorySnapshot_t>(*switched);
+
+    spliced->truncate(n_points / 2);
+    spliced->append(tail, 0, nullptr);
+
+    const double splice_us = elapsedUs(start);
+
+    checksum += spliced->point(spliced->size - 1, cursor)(0);
+
+    printf("snapshot (4xN blocks):\n");
+    printf("  load %.0f us, resample %.3f us, odometry switch %.1f us, resample after the switch %.3f us, splice of %d points %.0f us\n", load_us,
+           resample_us, offset_us, resample_switched_us, n_splice, splice_us);
+  }
+
+  //}
+
+  /* four vectors //{ */
+
+  {
+    auto start = steady_clock::now();
+
+    FourVectors_t trajectory = loadFourVectors(points);
+
+    const double load_us = elapsedUs(start);
+
+    start = steady_clock::now();
+
+    for (int t = 0; t < n_ticks; t++) {
+
+      const double time = t * dt1;
+      const int    idx  = std::clamp(int(std::floor(time / trajectory_dt + 1e-9)), 0, n_points - 1);
+
+      resampleFourVectors(trajectory, (*stencils)[int(std::round((time - idx * trajectory_dt) / dt1))], idx, des_x, des_y, des_z, des_heading);
+      checksum += des_x(0);
+    }
+
+    const double resample_us = elapsedUs(start) / n_ticks;
+
+    start = steady_clock::now();
+
+    offsetFourVectors(trajectory, rotation, old_position, new_position, shift);
+
+    const double offset_us = elapsedUs(start);
+
+    checksum += trajectory.x(n_points - 1);
+
+    printf("four vectors (before):\n");
+    printf("  load %.0f us, resample %.3f us, odometry switch %.1f us\n", load_us, resample_us, offset_us);
+  }
+
+  //}
+
+  // keeps the compiler from dropping the work
+  printf("\n(checksum %g)\n", checksum);
+
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "../test/mpc_tracker/mpc_tracker_fixture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace mrs_uav_trackers::test;
+
+/* TEST_F(MpcTrackerFixture, UpdateLatency) //{ */
+
+// the latency of update() as the control manager sees it, measured while the MPC tracks a trajectory and runs its iterations in parallel
+// only the interface of the tracker is used, so the same bench measures any version of the tracker
+TEST_F(MpcTrackerFixture, UpdateLatency) {
+
+  const double duration = nh_.param("duration", 60.0);
+  const double rate     = 100.0;  // of the control manager
+
+  mrs_msgs::TrajectoryReferenceSrvRequest::Ptr load(new mrs_msgs::TrajectoryReferenceSrvRequest());
+
+  load->trajectory         = circle(int(duration / 0.2) + 100);
+  load->trajectory.fly_now = true;
+
+  const auto load_response = tracker_->setTrajectoryReference(load);
+
+  ASSERT_TRUE(load_response->success) << load_response->message;
+
+  std::vector<double> latencies;
+  latencies.reserve(size_t(duration * rate) + 1);
+
+  ros::Rate loop_rate(rate);
+
+  const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(duration);
+
+  while (ros::ok() && ros::WallTime::now() < end) {
+
+    // the state is prepared before, as the control manager has it ready
+    const mrs_msgs::UavState::ConstPtr uav_state = uavState();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const mrs_msgs::PositionCommand::ConstPtr command = tracker_->update(uav_state, mrs_msgs::AttitudeCommand::ConstPtr());
+
+    latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    ASSERT_TRUE(command);
+
+    loop_rate.sleep();
+  }
+
+  ASSERT_FALSE(latencies.empty());
+
+  std::sort(latencies.begin(), latencies.end());
+
+  const auto percentile = [&](const double p) { return latencies[std::min(latencies.size() - 1, size_t(p / 100.0 * latencies.size()))]; };
+
+  printf("update() latency over %zu calls [us]: p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n", latencies.size(), percentile(50), percentile(90),
+         percentile(99), percentile(99.9), latencies.back());
+
+  // also stored in the xml result of the test
+  RecordProperty("n_calls", int(latencies.size()));
+  RecordProperty("p50_us", std::to_string(percentile(50)));
+  RecordProperty("p99_us", std::to_string(percentile(99)));
+  RecordProperty("p99_9_us", std::to_string(percentile(99.9)));
+  RecordProperty("max_us", std::to_string(latencies.back()));
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  ros::init(argc, argv, "bench_mpc_tracker_update_latency");
+
+  ros::NodeHandle nh;
+
+  return RUN_ALL_TESTS();
+}
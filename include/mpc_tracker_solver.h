@@ -4,34 +4,854 @@
 #include <ros/ros.h>
 #include <eigen3/Eigen/Eigen>
 
+#include <chrono>
+#include <numeric>
+
 namespace mrs_mpc_solvers
 {
 
 namespace mpc_tracker
 {
 
-class Solver {
+/* SolverStatus_t //{ */
+
+// how the last solve ended
+enum SolverStatus_t
+{
+  SOLVER_CONVERGED      = 0,
+  SOLVER_MAX_ITERATIONS = 1,
+  SOLVER_DEADLINE       = 2,
+  SOLVER_STEADY_STATE   = 3,  // the axis is at rest at a constant reference, the hold was returned without iterating
+};
+
+//}
+
+/* class SolverImpl //{ */
+
+/**
+ * @brief MPC solver for a single axis of the MpcTracker.
+ *
+ * The axis is modelled as a chain of integrators (position, velocity, acceleration, jerk, ...) driven by its highest derivative.
+ * The length of the horizon and the length of every step are set at construction, the horizon may be at most MaxHorizonLen steps long.
+ * The memory is allocated statically for the longest horizon.
+ *
+ * The solver minimizes
+ *
+ *   sum_{k=1..N} 1/2 (x_k - r_k)' Q (x_k - r_k) + sum_{k=0..N-1} 1/2 R u_k^2
+ *
+ * where the input weight is scaled by the length of the step (R = R_unit * dt_k). Without the scaling, the short first step would be
+ * penalized as much as the long ones and the closed loop of the receding horizon becomes unstable.
+ *
+ * The cost is minimized subject to the model and box constraints on all the derivatives of the position and on the input. The QP is solved by ADMM, the equality
+ * constrained subproblem is solved by a Riccati recursion which is precomputed whenever the weights change. Every iteration is therefore
+ * only a backward and a forward pass over the horizon. The limits enter only the projection of the slacks, so the factorization depends
+ * on the weights alone. The factorizations of the last few weight sets are cached, switching between them (e.g., when braking) is free.
+ *
+ * The slacks and the duals can be kept between consecutive solves (warm start). The horizon starts with a step as long as the period of
+ * the solves, therefore the samples of two consecutive problems lie almost at the same time and the previous solution is reused without
+ * shifting it.
+ *
+ * The solve can be bounded by a wall-clock deadline. When the deadline or the iteration limit is reached, the iterate with the lowest
+ * residual is returned. At least one iteration is always done, so there is always a dynamically feasible solution. The returned states and
+ * input are projected onto the limits, so they hold even when the solve is cut short.
+ *
+ * When the axis rests at a constant reference, the initial state integrated with zero input is returned without iterating, provided it stays
+ * within the steady state tolerance of the reference over the whole horizon. The first solve after the limits change always iterates.
+ *
+ * @tparam MaxHorizonLen the maximum length of the prediction horizon
+ * @tparam NStates       the number of states of the axis model (4 = position, velocity, acceleration, jerk)
+ */
+template <int MaxHorizonLen, int NStates>
+class SolverImpl {
 
 public:
-  Solver(std::string name, bool verbose, int max_iters, std::vector<double> tempQ, double dt, double dt2, int dim);
-
-  void   setInitialState(Eigen::MatrixXd &x);
-  bool   setVelQ(double Q_vel);
-  bool   setQ(std::vector<double> Qnew);
-  void   loadReference(Eigen::MatrixXd &reference);
-  void   setLimits(double max_speed, double min_speed, double max_acc, double min_acc, double max_jerk, double min_jerk, double max_snap, double min_snap);
-  int    solveMPC();
-  void   getStates(Eigen::MatrixXd &future_traj);
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  static const int max_horizon_len = MaxHorizonLen;
+
+  typedef Eigen::Matrix<double, NStates, 1>                                             state_t;
+  typedef Eigen::Matrix<double, NStates, NStates>                                       matrix_t;
+  typedef Eigen::Matrix<double, NStates, Eigen::Dynamic, 0, NStates, MaxHorizonLen + 1> states_t;   // states over the horizon
+  typedef Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, MaxHorizonLen>   inputs_t;   // inputs over the horizon
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MaxHorizonLen, 1>                 horizon_t;  // a reference over the horizon
+
+  SolverImpl(std::string name, bool verbose, int max_iters, std::vector<double> tempQ, std::vector<double> dts, int dim);
+
+  template <typename Derived>
+  void setInitialState(const Eigen::MatrixBase<Derived>& x);
+
+  bool setVelQ(double Q_vel);
+  bool setQ(std::vector<double> Qnew);
+
+  template <typename Derived>
+  void loadReference(const Eigen::MatrixBase<Derived>& reference);
+
+  void setLimits(double max_speed, double min_speed, double max_acc, double min_acc, double max_jerk, double min_jerk, double max_snap, double min_snap);
+  void setWarmStart(const bool warm_start);
+  void setSteadyStateTolerance(const double tolerance);
+  void resetWarmStart(void);
+  int  solveMPC();
+  int  solveMPC(const std::chrono::steady_clock::time_point& deadline);
+
+  SolverStatus_t getStatus(void);
+
+  template <typename Derived>
+  void getStates(Eigen::MatrixBase<Derived>& future_traj);
+
   double getFirstControlInput();
 
 private:
-  static const int _horizon_len_ = 40;
-  int              _dim_;
-  std::string      _name_;
+  // weight of the input per second of the step
+  static constexpr double _R_ = 5.0;
+
+  // ADMM penalty parameters, one per state and one for the input, set at construction
+  state_t rho_;
+  double  rho_u_;
+
+  // ADMM over-relaxation
+  static constexpr double _alpha_ = 1.6;
+
+  // ADMM stopping tolerances
+  static constexpr double _primal_tol_ = 1e-3;
+  static constexpr double _dual_tol_   = 1e-3;
+
+  // number of cached Riccati factorizations
+  static const int _n_factorizations_ = 4;
+
+  int         horizon_len_;
+  int         _dim_;
+  std::string _name_;
+  bool        _verbose_;
+  int         _max_iters_;
 
   std::vector<double> myQ_;
+
+  bool warm_start_       = true;
+  bool warm_start_valid_ = false;
+
+  SolverStatus_t status_ = SOLVER_CONVERGED;
+
+  double steady_state_tol_ = 0;  // 0 = always iterate
+  bool   limits_changed_   = true;  // since the last solve, the steady state is not held then
+
+  // | ------------------------- model ------------------------- |
+
+  std::array<matrix_t, MaxHorizonLen> A_;  // every step of the horizon may have a different length
+  std::array<state_t, MaxHorizonLen>  B_;
+  std::array<double, MaxHorizonLen>   dt_;
+
+  // | ---------------------- problem data ---------------------- |
+
+  state_t   x0_;
+  horizon_t reference_;
+  state_t   x_min_, x_max_;
+  double    u_min_, u_max_;
+  state_t   rho_mask_;  // which states are constrained
+  state_t   Q_diag_;
+
+  // | ------------------ precomputed Riccati ------------------- |
+
+  struct Factorization_t
+  {
+    state_t                             Q_diag;  // the weights it was computed for
+    bool                                valid     = false;
+    unsigned long                       last_used = 0;
+    states_t                            K;       // feedback gains (transposed)
+    inputs_t                            S_inv;   // inverse of the reduced Hessian
+    std::array<matrix_t, MaxHorizonLen> A_cl_t;  // transposed closed loop matrices
+  };
+
+  std::array<Factorization_t, _n_factorizations_> factorizations_;
+
+  const Factorization_t* riccati_       = nullptr;  // the factorization of the current weights, nullptr when the weights changed
+  unsigned long          riccati_clock_ = 0;
+
+  // | ------------------------ iterates ------------------------ |
+
+  states_t x_;  // states, x_.col(0) is the initial condition
+  inputs_t u_;  // inputs
+  states_t z_;  // state slack
+  states_t y_;  // state scaled dual
+  inputs_t w_;  // input slack
+  inputs_t g_;  // input scaled dual
+
+  states_t x_relaxed_;  // over-relaxed states
+  inputs_t u_relaxed_;  // over-relaxed inputs
+
+  states_t x_best_;  // the iterate with the lowest residual
+  inputs_t u_best_;
+
+  states_t q_;  // linear cost of the states
+  inputs_t r_;  // linear cost of the inputs
+  states_t p_;  // linear part of the cost-to-go
+  inputs_t d_;  // feedforward
+
+  void     buildModel(const double dt, matrix_t& A, state_t& B);
+  void     selectRiccati(void);
+  void     precomputeRiccati(Factorization_t& factorization);
+  void     coldStart(void);
+  void     updateLinearCost(void);
+  void     backwardPass(void);
+  void     forwardPass(void);
+  double   updateSlacks(void);
+  double   updateDuals(void);
+  bool     isSteadyState(void);
+  void     holdSteadyState(void);
 };
 
+//}
+
+/* SolverImpl() //{ */
+
+template <int MaxHorizonLen, int NStates>
+SolverImpl<MaxHorizonLen, NStates>::SolverImpl(std::string name, bool verbose, int max_iters, std::vector<double> tempQ, std::vector<double> dts,
+                                                int dim) {
+
+  _name_      = name;
+  _verbose_   = verbose;
+  _max_iters_ = max_iters;
+  _dim_       = dim;
+
+  // dts[k] is the length of the k-th step
+  if (dts.empty() || int(dts.size()) > MaxHorizonLen) {
+
+    ROS_ERROR("[%s]: the horizon of the solver (dim %d) has %d steps, it can have 1 to %d steps", _name_.c_str(), _dim_, int(dts.size()), MaxHorizonLen);
+    ros::shutdown();
+
+    dts.resize(std::clamp(int(dts.size()), 1, MaxHorizonLen), 0.01);
+  }
+
+  horizon_len_ = int(dts.size());
+
+  for (int k = 0; k < horizon_len_; k++) {
+    dt_[k] = dts[k];
+    buildModel(dt_[k], A_[k], B_[k]);
+  }
+
+  myQ_ = tempQ;
+  myQ_.resize(NStates, 0.0);
+
+  for (int i = 0; i < NStates; i++) {
+    Q_diag_(i) = myQ_[i];
+  }
+
+  // the position is never constrained
+  rho_mask_    = state_t::Ones();
+  rho_mask_(0) = 0;
+
+  // The derivatives differ in scale by orders of magnitude, a single penalty makes ADMM converge so slowly that the returned iterate
+  // violates the limits. Each penalty is scaled as the weight of the position would be if it was expressed in that derivative over
+  // an average step.
+  {
+    const double dt_mean  = std::accumulate(dts.begin(), dts.end(), 0.0) / horizon_len_;
+    const double rho_base = Q_diag_(0) > 0 ? Q_diag_(0) : 1.0;
+
+    rho_(0) = 0;
+
+    for (int i = 1; i < NStates; i++) {
+      rho_(i) = rho_base * std::pow(dt_mean, i);
+    }
+
+    rho_u_ = rho_base * std::pow(dt_mean, NStates);
+  }
+
+  x_min_ = state_t::Constant(std::numeric_limits<double>::lowest());
+  x_max_ = state_t::Constant(std::numeric_limits<double>::max());
+  u_min_ = std::numeric_limits<double>::lowest();
+  u_max_ = std::numeric_limits<double>::max();
+
+  x0_.setZero();
+  reference_ = horizon_t::Zero(horizon_len_);
+
+  for (auto& factorization : factorizations_) {
+    factorization.K.resize(NStates, horizon_len_);
+    factorization.S_inv.resize(horizon_len_);
+  }
+
+  for (auto* states : {&x_, &z_, &y_, &x_relaxed_, &x_best_, &q_, &p_}) {
+    states->resize(NStates, horizon_len_ + 1);
+  }
+
+  for (auto* inputs : {&u_, &w_, &g_, &u_relaxed_, &u_best_, &r_, &d_}) {
+    inputs->resize(horizon_len_);
+  }
+
+  q_.setZero();
+
+  coldStart();
+}
+
+//}
+
+/* buildModel() //{ */
+
+// the same discretization as the model of the virtual UAV in the tracker
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::buildModel(const double dt, matrix_t& A, state_t& B) {
+
+  A.setIdentity();
+
+  for (int i = 0; i < NStates - 1; i++) {
+    A(i, i + 1) = dt;
+  }
+
+  for (int i = 0; i < NStates - 2; i++) {
+    A(i, i + 2) = 0.5 * dt * dt;
+  }
+
+  B.setZero();
+  B(NStates - 1) = dt;
+}
+
+//}
+
+/* setInitialState() //{ */
+
+template <int MaxHorizonLen, int NStates>
+template <typename Derived>
+void SolverImpl<MaxHorizonLen, NStates>::setInitialState(const Eigen::MatrixBase<Derived>& x) {
+
+  for (int i = 0; i < NStates; i++) {
+    x0_(i) = x(i, 0);
+  }
+}
+
+//}
+
+/* setVelQ() //{ */
+
+template <int MaxHorizonLen, int NStates>
+bool SolverImpl<MaxHorizonLen, NStates>::setVelQ(double Q_vel) {
+
+  if (Q_diag_(1) != Q_vel) {
+
+    Q_diag_(1) = Q_vel;
+    myQ_[1]    = Q_vel;
+    riccati_   = nullptr;
+  }
+
+  return true;
+}
+
+//}
+
+/* setQ() //{ */
+
+template <int MaxHorizonLen, int NStates>
+bool SolverImpl<MaxHorizonLen, NStates>::setQ(std::vector<double> Qnew) {
+
+  if (int(Qnew.size()) != NStates) {
+    return false;
+  }
+
+  myQ_ = Qnew;
+
+  for (int i = 0; i < NStates; i++) {
+    Q_diag_(i) = myQ_[i];
+  }
+
+  riccati_ = nullptr;
+
+  return true;
+}
+
+//}
+
+/* loadReference() //{ */
+
+template <int MaxHorizonLen, int NStates>
+template <typename Derived>
+void SolverImpl<MaxHorizonLen, NStates>::loadReference(const Eigen::MatrixBase<Derived>& reference) {
+
+  for (int i = 0; i < horizon_len_; i++) {
+    reference_(i) = reference(i, 0);
+  }
+}
+
+//}
+
+/* setLimits() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::setLimits(double max_speed, double min_speed, double max_acc, double min_acc, double max_jerk, double min_jerk,
+                                                double max_snap, double min_snap) {
+
+  const double max_limits[] = {max_speed, max_acc, max_jerk, max_snap};
+  const double min_limits[] = {min_speed, min_acc, min_jerk, min_snap};
+
+  const state_t x_max = x_max_;
+  const state_t x_min = x_min_;
+  const double  u_max = u_max_;
+  const double  u_min = u_min_;
+
+  // the states above the position are constrained, the last limit belongs to the input
+  for (int i = 1; i < NStates; i++) {
+    x_max_(i) = i <= 3 ? max_limits[i - 1] : std::numeric_limits<double>::max();
+    x_min_(i) = i <= 3 ? -min_limits[i - 1] : std::numeric_limits<double>::lowest();
+  }
+
+  u_max_ = NStates <= 4 ? max_limits[NStates - 1] : std::numeric_limits<double>::max();
+  u_min_ = NStates <= 4 ? -min_limits[NStates - 1] : std::numeric_limits<double>::lowest();
+
+  // the next solve iterates even at rest
+  if (x_max_ != x_max || x_min_ != x_min || u_max_ != u_max || u_min_ != u_min) {
+    limits_changed_ = true;
+  }
+}
+
+//}
+
+/* setWarmStart() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::setWarmStart(const bool warm_start) {
+
+  warm_start_ = warm_start;
+}
+
+//}
+
+/* setSteadyStateTolerance() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::setSteadyStateTolerance(const double tolerance) {
+
+  steady_state_tol_ = tolerance;
+}
+
+//}
+
+/* resetWarmStart() //{ */
+
+// the next solve starts from scratch, e.g., when the initial state jumps
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::resetWarmStart(void) {
+
+  warm_start_valid_ = false;
+}
+
+//}
+
+/* selectRiccati() //{ */
+
+// picks the cached factorization of the current weights, computes it in place of the least recently used one if it is not cached
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::selectRiccati(void) {
+
+  Factorization_t* selected = nullptr;
+
+  for (auto& factorization : factorizations_) {
+
+    if (factorization.valid && factorization.Q_diag == Q_diag_) {
+      selected = &factorization;
+      break;
+    }
+  }
+
+  if (selected == nullptr) {
+
+    selected = &factorizations_[0];
+
+    for (auto& factorization : factorizations_) {
+
+      if (!factorization.valid) {
+        selected = &factorization;
+        break;
+      }
+
+      if (factorization.last_used < selected->last_used) {
+        selected = &factorization;
+      }
+    }
+
+    precomputeRiccati(*selected);
+
+    if (_verbose_) {
+      ROS_INFO("[%s]: solver (dim %d) factorized the weights [%.2f, %.2f, %.2f, %.2f]", _name_.c_str(), _dim_, Q_diag_(0), Q_diag_(1), Q_diag_(2),
+               Q_diag_(NStates - 1));
+    }
+  }
+
+  selected->last_used = ++riccati_clock_;
+
+  riccati_ = selected;
+}
+
+//}
+
+/* precomputeRiccati() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::precomputeRiccati(Factorization_t& factorization) {
+
+  states_t&                            K      = factorization.K;
+  inputs_t&                            S_inv  = factorization.S_inv;
+  std::array<matrix_t, MaxHorizonLen>& A_cl_t = factorization.A_cl_t;
+
+  const matrix_t Q_tilde = (Q_diag_ + rho_).asDiagonal();
+
+  matrix_t P = Q_tilde;
+
+  for (int k = horizon_len_ - 1; k >= 0; k--) {
+
+    const matrix_t& A = A_[k];
+    const state_t&  B = B_[k];
+
+    const double R_tilde = _R_ * dt_[k] + rho_u_;
+
+    const state_t PB = P * B;
+    const double  S  = R_tilde + B.dot(PB);
+
+    S_inv(k) = 1.0 / S;
+    K.col(k) = A.transpose() * PB * S_inv(k);
+
+    const matrix_t A_cl = A - B * K.col(k).transpose();
+
+    A_cl_t[k] = A_cl.transpose();
+
+    P = Q_tilde + A.transpose() * P * A_cl;
+    P = 0.5 * (P + P.transpose()).eval();
+  }
+
+  factorization.Q_diag = Q_diag_;
+  factorization.valid  = true;
+}
+
+//}
+
+/* coldStart() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::coldStart(void) {
+
+  x_.setZero();
+  u_.setZero();
+  z_.setZero();
+  y_.setZero();
+  w_.setZero();
+  g_.setZero();
+  p_.setZero();
+  d_.setZero();
+}
+
+//}
+
+/* updateLinearCost() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::updateLinearCost(void) {
+
+  for (int k = 1; k <= horizon_len_; k++) {
+    q_.col(k) = -rho_.cwiseProduct(z_.col(k) - y_.col(k));
+    q_(0, k) -= Q_diag_(0) * reference_(k - 1);
+  }
+
+  r_ = -rho_u_ * (w_ - g_);
+}
+
+//}
+
+/* backwardPass() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::backwardPass(void) {
+
+  const states_t&                            K      = riccati_->K;
+  const inputs_t&                            S_inv  = riccati_->S_inv;
+  const std::array<matrix_t, MaxHorizonLen>& A_cl_t = riccati_->A_cl_t;
+
+  p_.col(horizon_len_) = q_.col(horizon_len_);
+
+  for (int k = horizon_len_ - 1; k >= 0; k--) {
+
+    const state_t& B = B_[k];
+
+    d_(k) = S_inv(k) * (B.dot(p_.col(k + 1)) + r_(k));
+
+    p_.col(k) = q_.col(k) + A_cl_t[k] * p_.col(k + 1) - K.col(k) * r_(k);
+  }
+}
+
+//}
+
+/* forwardPass() //{ */
+
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::forwardPass(void) {
+
+  const states_t& K = riccati_->K;
+
+  x_.col(0) = x0_;
+
+  for (int k = 0; k < horizon_len_; k++) {
+
+    const matrix_t& A = A_[k];
+    const state_t&  B = B_[k];
+
+    u_(k)         = -K.col(k).dot(x_.col(k)) - d_(k);
+    x_.col(k + 1) = A * x_.col(k) + B * u_(k);
+  }
+}
+
+//}
+
+/* updateSlacks() //{ */
+
+// projects the primal iterate onto the constraints, returns the dual residual
+template <int MaxHorizonLen, int NStates>
+double SolverImpl<MaxHorizonLen, NStates>::updateSlacks(void) {
+
+  double dual_residual = 0;
+
+  for (int k = 1; k <= horizon_len_; k++) {
+
+    x_relaxed_.col(k) = _alpha_ * x_.col(k) + (1.0 - _alpha_) * z_.col(k);
+
+    const state_t z_new = (x_relaxed_.col(k) + y_.col(k)).cwiseMax(x_min_).cwiseMin(x_max_);
+
+    dual_residual = std::max(dual_residual, rho_.cwiseProduct(z_new - z_.col(k)).cwiseAbs().maxCoeff());
+
+    z_.col(k) = z_new;
+  }
+
+  for (int k = 0; k < horizon_len_; k++) {
+
+    u_relaxed_(k) = _alpha_ * u_(k) + (1.0 - _alpha_) * w_(k);
+
+    const double w_new = std::min(std::max(u_relaxed_(k) + g_(k), u_min_), u_max_);
+
+    dual_residual = std::max(dual_residual, rho_u_ * std::abs(w_new - w_(k)));
+
+    w_(k) = w_new;
+  }
+
+  return dual_residual;
+}
+
+//}
+
+/* updateDuals() //{ */
+
+// updates the scaled duals, returns the primal residual
+template <int MaxHorizonLen, int NStates>
+double SolverImpl<MaxHorizonLen, NStates>::updateDuals(void) {
+
+  double primal_residual = 0;
+
+  for (int k = 1; k <= horizon_len_; k++) {
+
+    primal_residual = std::max(primal_residual, rho_mask_.cwiseProduct(x_.col(k) - z_.col(k)).cwiseAbs().maxCoeff());
+
+    y_.col(k) += rho_mask_.cwiseProduct(x_relaxed_.col(k) - z_.col(k));
+  }
+
+  primal_residual = std::max(primal_residual, (u_ - w_).cwiseAbs().maxCoeff());
+
+  g_ += u_relaxed_ - w_;
+
+  return primal_residual;
+}
+
+//}
+
+/* isSteadyState() //{ */
+
+// the axis is at rest and the whole reference lies at its position
+// the hold is the initial state integrated with zero input, it has to stay at the reference and within the limits over the whole horizon,
+// it is left in x_ for holdSteadyState()
+template <int MaxHorizonLen, int NStates>
+bool SolverImpl<MaxHorizonLen, NStates>::isSteadyState(void) {
+
+  if (steady_state_tol_ <= 0 || limits_changed_) {
+    return false;
+  }
+
+  if (x0_.tail(NStates - 1).cwiseAbs().maxCoeff() > steady_state_tol_) {
+    return false;
+  }
+
+  x_.col(0) = x0_;
+
+  for (int k = 0; k < horizon_len_; k++) {
+
+    x_.col(k + 1) = A_[k] * x_.col(k);
+
+    if (std::abs(x_(0, k + 1) - reference_(k)) > steady_state_tol_) {
+      return false;
+    }
+
+    if ((x_.col(k + 1).array() < x_min_.array()).any() || (x_.col(k + 1).array() > x_max_.array()).any()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//}
+
+/* holdSteadyState() //{ */
+
+// the solution at rest, the states were integrated by isSteadyState(), the constraints are inactive, so the slacks equal the primal and the
+// duals are zero
+template <int MaxHorizonLen, int NStates>
+void SolverImpl<MaxHorizonLen, NStates>::holdSteadyState(void) {
+
+  u_.setZero();
+
+  z_ = x_;
+  y_.setZero();
+  w_.setZero();
+  g_.setZero();
+
+  warm_start_valid_ = true;
+}
+
+//}
+
+/* solveMPC() //{ */
+
+template <int MaxHorizonLen, int NStates>
+int SolverImpl<MaxHorizonLen, NStates>::solveMPC() {
+
+  return solveMPC(std::chrono::steady_clock::time_point::max());
+}
+
+template <int MaxHorizonLen, int NStates>
+int SolverImpl<MaxHorizonLen, NStates>::solveMPC(const std::chrono::steady_clock::time_point& deadline) {
+
+  if (riccati_ == nullptr) {
+    selectRiccati();
+  }
+
+  if (isSteadyState()) {
+
+    holdSteadyState();
+
+    status_ = SOLVER_STEADY_STATE;
+
+    return 0;
+  }
+
+  if (!warm_start_ || !warm_start_valid_) {
+    coldStart();
+  }
+
+  int    iters           = 0;
+  double primal_residual = std::numeric_limits<double>::max();
+  double dual_residual   = std::numeric_limits<double>::max();
+  double best_residual   = std::numeric_limits<double>::max();
+  bool   last_is_best    = true;
+
+  status_ = SOLVER_MAX_ITERATIONS;
+
+  while (iters < _max_iters_) {
+
+    iters++;
+
+    updateLinearCost();
+    backwardPass();
+    forwardPass();
+
+    dual_residual   = updateSlacks();
+    primal_residual = updateDuals();
+
+    if (primal_residual < _primal_tol_ && dual_residual < _dual_tol_) {
+      status_      = SOLVER_CONVERGED;
+      last_is_best = true;
+      break;
+    }
+
+    // remember the best iterate in case the solver does not converge in time
+    const double residual = std::max(primal_residual, dual_residual);
+
+    if (residual < best_residual) {
+
+      best_residual = residual;
+      x_best_       = x_;
+      u_best_       = u_;
+      last_is_best  = true;
+
+    } else {
+
+      last_is_best = false;
+    }
+
+    if (std::chrono::steady_clock::now() >= deadline) {
+      status_ = SOLVER_DEADLINE;
+      break;
+    }
+  }
+
+  if (!last_is_best) {
+    x_ = x_best_;
+    u_ = u_best_;
+  }
+
+  limits_changed_ = false;
+
+  if (!x_.allFinite() || !u_.allFinite()) {
+
+    ROS_ERROR_THROTTLE(1.0, "[%s]: solver (dim %d) produced non-finite values", _name_.c_str(), _dim_);
+
+    coldStart();
+
+    warm_start_valid_ = false;
+
+  } else {
+
+    warm_start_valid_ = true;
+  }
+
+  if (_verbose_) {
+    ROS_INFO_THROTTLE(1.0, "[%s]: solver (dim %d): iters %d, status %d, primal residual %.5f, dual residual %.5f", _name_.c_str(), _dim_, iters, status_,
+                      primal_residual, dual_residual);
+  }
+
+  return iters;
+}
+
+//}
+
+/* getStatus() //{ */
+
+template <int MaxHorizonLen, int NStates>
+SolverStatus_t SolverImpl<MaxHorizonLen, NStates>::getStatus(void) {
+
+  return status_;
+}
+
+//}
+
+/* getStates() //{ */
+
+// fills the predicted states into the tracker's vector, which interleaves all three axes sample by sample
+// the states are projected onto the limits, the primal iterate satisfies them only up to the residual
+template <int MaxHorizonLen, int NStates>
+template <typename Derived>
+void SolverImpl<MaxHorizonLen, NStates>::getStates(Eigen::MatrixBase<Derived>& future_traj) {
+
+  for (int k = 0; k < horizon_len_; k++) {
+    for (int j = 0; j < NStates; j++) {
+      future_traj(k * 3 * NStates + _dim_ * NStates + j, 0) = std::min(std::max(x_(j, k + 1), x_min_(j)), x_max_(j));
+    }
+  }
+}
+
+//}
+
+/* getFirstControlInput() //{ */
+
+template <int MaxHorizonLen, int NStates>
+double SolverImpl<MaxHorizonLen, NStates>::getFirstControlInput() {
+
+  return std::min(std::max(u_(0), u_min_), u_max_);
+}
+
+//}
+
+typedef SolverImpl<100, 4> Solver;
+
 }  // namespace mpc_tracker
 
 }  // namespace mrs_mpc_solvers
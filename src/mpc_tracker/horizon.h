@@ -0,0 +1,12 @@
+#ifndef MPC_TRACKER_HORIZON_H
+#define MPC_TRACKER_HORIZON_H
+
+#include <eigen3/Eigen/Eigen>
+
+#define MPC_MAX_HORIZON_LEN 100  // the horizon length is loaded, the memory is allocated for the longest one
+
+using mpc_horizon_t       = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MPC_MAX_HORIZON_LEN, 1>;  // a reference over the prediction horizon
+using mpc_horizon_array_t = Eigen::Array<double, Eigen::Dynamic, 1, 0, MPC_MAX_HORIZON_LEN, 1>;   // a value per sample of the horizon
+using mpc_positions_t     = Eigen::Array<double, Eigen::Dynamic, 3, 0, MPC_MAX_HORIZON_LEN, 3>;   // positions over the horizon, columns x, y, z
+
+#endif
@@ -8,13 +8,18 @@
 
 #include <geometry_msgs/Pose.h>
 #include <geometry_msgs/PoseArray.h>
+#include <geometry_msgs/TransformStamped.h>
 
 #include <mrs_msgs/FuturePoint.h>
 #include <mrs_msgs/FutureTrajectory.h>
+#include <mrs_msgs/TrajectoryReference.h>
 #include <mrs_msgs/MpcTrackerDiagnostics.h>
 #include <mrs_msgs/EstimatorType.h>
+#include <mrs_msgs/String.h>
 
 #include <std_msgs/String.h>
+#include <std_msgs/Int32MultiArray.h>
+#include <std_msgs/Float64MultiArray.h>
 
 #include <mrs_lib/profiler.h>
 #include <mrs_lib/utils.h>
@@ -28,6 +33,16 @@
 #include <dynamic_reconfigure/server.h>
 #include <mpc_tracker_solver.h>
 
+#include "horizon.h"
+#include "worker_pool.h"
+#include "realtime_loop.h"
+#include "seq_lock.h"
+#include "trajectory_file.h"
+#include "trajectory_snapshot.h"
+#include "other_uavs.h"
+
+#include <sys/mman.h>
+
 #include <mrs_uav_trackers/mpc_trackerConfig.h>
 
 #include <visualization_msgs/Marker.h>
@@ -39,6 +54,25 @@
 
 using quat_t = Eigen::Quaterniond;
 
+// the sizes of the model, the loaded parameters have to match them
+#define MPC_N_STATES 12
+#define MPC_N_INPUTS 3
+#define MPC_N_STATES_HEADING 4
+#define MPC_N_INPUTS_HEADING 1
+// MPC_MAX_HORIZON_LEN and the types over the horizon are defined in horizon.h
+
+using mpc_state_t         = Eigen::Matrix<double, MPC_N_STATES, 1>;
+using mpc_input_t         = Eigen::Matrix<double, MPC_N_INPUTS, 1>;
+using mpc_A_t             = Eigen::Matrix<double, MPC_N_STATES, MPC_N_STATES>;
+using mpc_B_t             = Eigen::Matrix<double, MPC_N_STATES, MPC_N_INPUTS>;
+using mpc_state_heading_t = Eigen::Matrix<double, MPC_N_STATES_HEADING, 1>;
+using mpc_A_heading_t     = Eigen::Matrix<double, MPC_N_STATES_HEADING, MPC_N_STATES_HEADING>;
+using mpc_B_heading_t     = Eigen::Matrix<double, MPC_N_STATES_HEADING, MPC_N_INPUTS_HEADING>;
+using mpc_axis_state_t    = Eigen::Matrix<double, MPC_N_STATES / 3, 1>;               // states of a single axis
+using mpc_prediction_t    = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MPC_MAX_HORIZON_LEN * MPC_N_STATES, 1>;  // all the states over the horizon
+
+static_assert(mrs_mpc_solvers::mpc_tracker::Solver::max_horizon_len == MPC_MAX_HORIZON_LEN, "the solver has to fit the longest horizon");
+
 //}
 
 /* using //{ */
@@ -59,10 +93,68 @@ namespace mrs_uav_trackers
 namespace mpc_tracker
 {
 
+/* //{ toIsometry() */
+
+// the transformation which tf2::doTransform() applies to a point, it can then be applied to many points at once
+Eigen::Isometry3d toIsometry(const geometry_msgs::TransformStamped& tf) {
+
+  const geometry_msgs::Vector3&    t = tf.transform.translation;
+  const geometry_msgs::Quaternion& q = tf.transform.rotation;
+
+  Eigen::Isometry3d isometry = Eigen::Isometry3d::Identity();
+
+  isometry.linear()      = Eigen::Quaterniond(q.w, q.x, q.y, q.z).normalized().toRotationMatrix();
+  isometry.translation() = Eigen::Vector3d(t.x, t.y, t.z);
+
+  return isometry;
+}
+
+//}
+
+/* //{ struct ModelState_t */
+
+// the state of the virtual UAV
+struct ModelState_t
+{
+  PlainMatrix<mpc_state_t>         x;
+  PlainMatrix<mpc_state_heading_t> heading;
+};
+
+//}
+
+/* //{ struct ModelInput_t */
+
+// the first input of the MPC solution
+struct ModelInput_t
+{
+  PlainMatrix<mpc_input_t> u;
+  double                   heading;
+};
+
+//}
+
+/* //{ struct MpcDebug_t */
+
+// what the MPC iteration leaves for the debugging topics, they are published by timerDiagnostics(), so the iteration does not allocate
+struct MpcDebug_t
+{
+  PlainMatrix<mpc_horizon_t> reference_x;  // the filtered reference of the solvers
+  PlainMatrix<mpc_horizon_t> reference_y;
+  PlainMatrix<mpc_horizon_t> reference_z;
+  PlainMatrix<mpc_horizon_t> reference_heading;
+
+  std::array<std::int32_t, 4> iterations;  // x, y, z, heading
+  std::array<std::int32_t, 4> status;
+};
+
+//}
+
 /* //{ class MpcTracker */
 
 class MpcTracker : public mrs_uav_managers::Tracker {
 public:
+  ~MpcTracker();
+
   void initialize(const ros::NodeHandle& parent_nh, const std::string uav_name, std::shared_ptr<mrs_uav_managers::CommonHandlers_t> common_handlers);
   std::tuple<bool, std::string> activate(const mrs_msgs::PositionCommand::ConstPtr& last_position_cmd);
   void                          deactivate(void);
@@ -96,6 +188,10 @@ private:
   // debugging publishers
   ros::Publisher pub_diagnostics_;
   ros::Publisher pub_status_string_;
+  ros::Publisher pub_solver_iterations_;
+  ros::Publisher pub_solver_status_;
+  ros::Publisher pub_mpc_loop_jitter_;
+  ros::Publisher pub_avoidance_transform_cache_;
 
   ros::Publisher pub_debug_processed_trajectory_poses_;
   ros::Publisher pub_debug_processed_trajectory_markers_;
@@ -133,41 +229,49 @@ private:
   double _dt1_;
   double _dt2_;
 
-  MatrixXd  _A_;  // system matrix for virtual UAV
-  MatrixXd  _B_;  // input matrix for virtual UAV
-  MatrixXd  A_;   // system matrix for virtual UAV
-  MatrixXd  B_;   // input matrix for virtual UAV
+  std::vector<double> sample_dt_;    // the spacing of the samples over the horizon, sample_dt_[0] = dt1
+  std::vector<double> sample_time_;  // the time of the samples over the horizon, relative to the current state
+
+  // indices of the reference samples compared by the braking logic
+  int _braking_idx_near_;
+  int _braking_idx_near_heading_;
+  int _braking_idx_far_;
+
+  mpc_A_t   _A_;  // system matrix for virtual UAV
+  mpc_B_t   _B_;  // input matrix for virtual UAV
+  mpc_A_t   A_;   // system matrix for virtual UAV
+  mpc_B_t   B_;   // input matrix for virtual UAV
   bool      model_first_iteration_ = true;
   ros::Time model_iteration_last_time_;
 
-  MatrixXd _A_heading_;  // system matrix for heading
-  MatrixXd _B_heading_;  // input matrix for heading
-  MatrixXd A_heading_;   // system matrix for heading
-  MatrixXd B_heading_;   // input matrix for heading
+  mpc_A_heading_t _A_heading_;  // system matrix for heading
+  mpc_B_heading_t _B_heading_;  // input matrix for heading
+  mpc_A_heading_t A_heading_;   // system matrix for heading
+  mpc_B_heading_t B_heading_;   // input matrix for heading
 
   // the reference over the prediction horizon per axis
-  MatrixXd   des_x_trajectory_;
-  MatrixXd   des_y_trajectory_;
-  MatrixXd   des_z_trajectory_;
-  MatrixXd   des_heading_trajectory_;
-  std::mutex mutex_des_trajectory_;
+  mpc_horizon_t des_x_trajectory_;
+  mpc_horizon_t des_y_trajectory_;
+  mpc_horizon_t des_z_trajectory_;
+  mpc_horizon_t des_heading_trajectory_;
+  std::mutex    mutex_des_trajectory_;
 
   // the reference filtered over the prediction horizon per axis
-  MatrixXd des_z_filtered_offset_;
+  mpc_horizon_t des_z_filtered_offset_;
 
-  // the whole trajectory reference split per axis
-  std::shared_ptr<VectorXd> des_x_whole_trajectory_;
-  std::shared_ptr<VectorXd> des_y_whole_trajectory_;
-  std::shared_ptr<VectorXd> des_z_whole_trajectory_;
-  std::shared_ptr<VectorXd> des_heading_whole_trajectory_;
-  std::mutex                mutex_des_whole_trajectory_;
+  // the whole trajectory reference, use std::atomic_load() and std::atomic_store() to access it
+  std::shared_ptr<const TrajectorySnapshot_t> whole_trajectory_;
 
   // trajectory tracking
+  // the progress is derived from the start time in every MPC iteration, a late iteration catches up with the clock
   bool       trajectory_tracking_in_progress_ = false;
-  int        trajectory_tracking_sub_idx_     = 0;  // increases with every iteration of the simulated model
-  int        trajectory_tracking_idx_         = 0;  // while tracking, this is the current index in the des_*_whole trajectory
+  ros::Time  trajectory_tracking_start_;         // when the tracking was at the time 0 of the trajectory
+  double     trajectory_tracking_time_     = 0;  // [s] the time along the trajectory reached by the last MPC iteration
   std::mutex mutex_trajectory_tracking_states_;
 
+  int              trajectory_cursor_        = 0;  // the cursor in a timed trajectory, used only by the MPC iteration
+  std::atomic<int> status_trajectory_cursor_ = 0;  // the cursor of getStatus(), it is only a hint, so the callers may race for it
+
   // params of the loaded trajectory
   int    trajectory_size_ = 0;
   double trajectory_dt_;
@@ -176,24 +280,24 @@ private:
   bool   trajectory_set_           = false;
   int    trajectory_count_         = 0;  // counts how many trajectories we have received
 
-  // mpc output
-  VectorXd   mpc_u_;
-  double     mpc_u_heading_;
-  std::mutex mutex_mpc_u_;
+  // mpc output, written only by the MPC iteration, update() reads it without locking
+  SeqLock<ModelInput_t> mpc_u_;
+
+  // current state of the dynamical system, the readers do not lock, so update() never waits for the MPC iteration
+  SeqLock<ModelState_t> mpc_x_;
+  std::mutex            mutex_mpc_x_;  // serializes the writers, a read-modify-write has to hold it
 
-  // current state of the dynamical system
-  MatrixXd   mpc_x_;          // current state of the uav
-  MatrixXd   mpc_x_heading_;  // current heading of the uav
-  std::mutex mutex_mpc_x_;
+  // written only by the MPC iteration
+  SeqLock<MpcDebug_t> mpc_debug_;
 
   // odometry reset
   bool odometry_reset_in_progress_ = false;
   bool mpc_result_invalid_         = false;
 
   // predicting the future
-  MatrixXd   predicted_trajectory_;
-  MatrixXd   predicted_heading_trajectory_;
-  std::mutex mutex_predicted_trajectory_;
+  mpc_prediction_t predicted_trajectory_;
+  mpc_prediction_t predicted_heading_trajectory_;
+  std::mutex       mutex_predicted_trajectory_;
 
   ros::Publisher publisher_predicted_trajectory_debugging_;
   ros::Publisher publisher_mpc_reference_debugging_;
@@ -214,6 +318,14 @@ private:
   int _max_iters_z_;
   int _max_iters_heading_;
 
+  bool mpc_warm_start_reset_ = true;  // the solvers should not reuse their last solution
+
+  double _solver_time_budget_;  // [-] fraction of dt1 given to the solvers
+
+  // the independent axes are solved in parallel when enabled
+  bool                        _parallel_solvers_ = false;
+  std::unique_ptr<WorkerPool> solver_pool_;
+
   // | ----------- measuring the "MPC realtime factor" ---------- |
 
   ros::Time mpc_start_time_;
@@ -243,6 +355,9 @@ private:
   // how old can the other UAV trajectory be (since receive time)
   double _collision_trajectory_timeout_;
 
+  // the transforms of the future trajectories are looked up again only after this time
+  double _avoidance_transform_validity_;
+
   // when collision detected, slow down during the manouver
   double _avoidance_collision_horizontal_speed_coef_;
 
@@ -264,22 +379,33 @@ private:
   // avoidance trajectory will not be published unless we computed it at least once
   bool future_was_predicted_ = false;
 
-  // subscribing to the other UAV future trajectories
-  void callbackOtherMavTrajectory(mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>& sh_ptr);
+  // the other UAVs, allocated in initialize(), the table is not resized afterwards
+  std::vector<OtherUav_t> other_uavs_;
+
+  // subscribing to the other UAV future trajectories, the index is the slot of the UAV in other_uavs_
+  void callbackOtherMavTrajectory(mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>& sh_ptr, const int index);
 
   std::vector<mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>> other_uav_trajectory_subscribers_;
-  std::map<std::string, mrs_msgs::FutureTrajectory>                  other_uav_avoidance_trajectories_;
-  std::mutex                                                         mutex_other_uav_avoidance_trajectories_;
 
   // subscribing to the other UAV diagnostics'
-  void callbackOtherMavDiagnostics(mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>& sh_ptr);
+  void callbackOtherMavDiagnostics(mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>& sh_ptr, const int index);
 
   std::vector<mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>> other_uav_diag_subscribers_;
-  std::map<std::string, mrs_msgs::MpcTrackerDiagnostics>                  other_uav_diagnostics_;
-  std::mutex                                                              mutex_other_uav_diagnostics_;
 
-  double checkCollision(const double ax, const double ay, const double az, const double bx, const double by, const double bz);
-  double checkCollisionInflated(const double ax, const double ay, const double az, const double bx, const double by, const double bz);
+  // the transforms between the current frame and the utm origin, keyed by [from, to]
+  // every received trajectory and every published prediction needs one, and it changes only slowly
+  struct CachedTransform_t {
+    Eigen::Isometry3d transform;
+    ros::Time         time;  // of the lookup
+  };
+
+  std::optional<Eigen::Isometry3d>                                   getAvoidanceTransform(const std::string& from, const std::string& to);
+  std::map<std::pair<std::string, std::string>, CachedTransform_t> transform_cache_;
+  std::mutex                                                         mutex_transform_cache_;
+  unsigned long                                                      transform_cache_hits_       = 0;
+  unsigned long                                                      transform_cache_misses_     = 0;
+  unsigned long                                                      transform_cache_generation_ = 0;  // incremented by every clear
+  void                                                               publishAvoidanceTransformCache(void);
 
   ros::Publisher avoidance_trajectory_publisher_;
 
@@ -292,10 +418,20 @@ private:
   bool       mpc_timer_running_ = false;
   void       timerMPC(const ros::TimerEvent& event);
 
+  // optionally, the MPC iterations run on a dedicated thread instead of the timer
+  bool                          _mpc_realtime_thread_;
+  int                           _mpc_thread_priority_;
+  int                           _mpc_thread_cpu_;
+  bool                          _mpc_lock_memory_;
+  std::unique_ptr<RealtimeLoop> mpc_loop_;
+  ros::Time                     mpc_loop_last_expected_;
+  ros::Time                     mpc_loop_last_real_;
+  void                          realtimeMPC(const double lateness);
+  void                          publishMpcLoopJitter(void);
+  void                          publishMpcDebug(void);
+
   // | ------------------- trajectory tracking ------------------ |
 
-  ros::Timer timer_trajectory_tracking_;
-  void       timerTrajectoryTracking(const ros::TimerEvent& event);
 
   // | ------------------ avoidance trajectory ------------------ |
 
@@ -331,14 +467,34 @@ private:
   void setRelativeGoal(const double pos_x, const double pos_y, const double pos_z, const double heading, const bool use_heading);
   void setSinglePointReference(const double x, const double y, const double z, const double heading);
 
-  std::tuple<bool, std::string, bool> loadTrajectory(const mrs_msgs::TrajectoryReference msg);
+  std::tuple<bool, std::string, bool> loadTrajectory(const mrs_msgs::TrajectoryReference& msg);
+
+  std::tuple<bool, std::string> spliceTrajectory(const mrs_msgs::TrajectoryReference& msg);
+  void                          publishTrajectoryDebug(const TrajectorySnapshot_t& trajectory, const std::string& frame_id);
+
+  ros::ServiceServer service_server_splice_trajectory_;
+  bool               callbackSpliceTrajectory(mrs_msgs::TrajectoryReferenceSrv::Request& req, mrs_msgs::TrajectoryReferenceSrv::Response& res);
+
+  std::tuple<bool, std::string> activateTrajectory(const std::shared_ptr<TrajectorySnapshot_t>& whole_trajectory, const bool fly_now, const bool use_heading,
+                                                   const double time_offset);
+
+  // | ------------------- trajectory library ------------------- |
+
+  std::string _trajectory_library_path_;  // the directory with the <name>.traj files
+
+  std::tuple<bool, std::string> loadLibraryTrajectory(const std::string& name);
 
-  MatrixXd                       filterReferenceZ(const VectorXd& des_z_trajectory, const double max_ascending_speed, const double max_descending_speed);
-  std::tuple<MatrixXd, MatrixXd> filterReferenceXY(const VectorXd& des_x_trajectory, const VectorXd& des_y_trajectory, double max_speed_x, double max_speed_y);
+  ros::ServiceServer service_server_trajectory_library_;
+  bool               callbackTrajectoryLibrary(mrs_msgs::String::Request& req, mrs_msgs::String::Response& res);
+
+  mpc_horizon_t filterReferenceZ(const mpc_horizon_t& des_z_trajectory, const double max_ascending_speed, const double max_descending_speed);
+  std::tuple<mpc_horizon_t, mpc_horizon_t> filterReferenceXY(const mpc_horizon_t& des_x_trajectory, const mpc_horizon_t& des_y_trajectory, double max_speed_x,
+                                                             double max_speed_y);
 
   double checkTrajectoryForCollisions(int& first_collision_index);
 
   void manageConstraints(void);
+  void runSolverTasks(const std::function<void()>* tasks, const int n_tasks);
   void calculateMPC(void);
   void iterateModel(void);
 
@@ -371,6 +527,18 @@ private:
 
 // | -------------- tracker's interface routines -------------- |
 
+/* //{ ~MpcTracker() */
+
+MpcTracker::~MpcTracker() {
+
+  // the MPC thread has to finish before the tracker is gone
+  if (mpc_loop_) {
+    mpc_loop_->stop();
+  }
+}
+
+//}
+
 /* //{ initialize() */
 
 void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] const std::string uav_name,
@@ -410,29 +578,93 @@ void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] c
 
   param_loader.loadParam("model/translation/n_states", _mpc_n_states_);
   param_loader.loadParam("model/translation/n_inputs", _mpc_m_states_);
-  param_loader.loadMatrixStatic("model/translation/A", _A_, _mpc_n_states_, _mpc_n_states_);
-  param_loader.loadMatrixStatic("model/translation/B", _B_, _mpc_n_states_, _mpc_m_states_);
+  param_loader.loadParam("model/heading/n_states", _mpc_n_states_heading_);
+  param_loader.loadParam("model/heading/n_inputs", _mpc_n_inputs_heading_);
+
+  // load the MPC parameters
+  param_loader.loadParam("mpc_solver/horizon_len", _mpc_horizon_len_);
+
+  // the model and the horizon are statically sized
+  if (_mpc_n_states_ != MPC_N_STATES || _mpc_m_states_ != MPC_N_INPUTS || _mpc_n_states_heading_ != MPC_N_STATES_HEADING ||
+      _mpc_n_inputs_heading_ != MPC_N_INPUTS_HEADING) {
+    ROS_ERROR("[MpcTracker]: the model size has to be %d states, %d inputs, %d heading states and %d heading inputs", MPC_N_STATES, MPC_N_INPUTS,
+              MPC_N_STATES_HEADING, MPC_N_INPUTS_HEADING);
+    ros::shutdown();
+  }
+
+  if (_mpc_horizon_len_ < 2 || _mpc_horizon_len_ > MPC_MAX_HORIZON_LEN) {
+    ROS_ERROR("[MpcTracker]: mpc_solver/horizon_len has to be between 2 and %d", MPC_MAX_HORIZON_LEN);
+    ros::shutdown();
+    return;  // the horizon buffers can not hold it
+  }
+
+  {
+    MatrixXd temp_A, temp_B;
+
+    param_loader.loadMatrixStatic("model/translation/A", temp_A, MPC_N_STATES, MPC_N_STATES);
+    param_loader.loadMatrixStatic("model/translation/B", temp_B, MPC_N_STATES, MPC_N_INPUTS);
+
+    _A_ = temp_A;
+    _B_ = temp_B;
+
+    param_loader.loadMatrixStatic("model/heading/A", temp_A, MPC_N_STATES_HEADING, MPC_N_STATES_HEADING);
+    param_loader.loadMatrixStatic("model/heading/B", temp_B, MPC_N_STATES_HEADING, MPC_N_INPUTS_HEADING);
+
+    _A_heading_ = temp_A;
+    _B_heading_ = temp_B;
+  }
 
   A_ = _A_;
   B_ = _B_;
 
-  param_loader.loadParam("model/heading/n_states", _mpc_n_states_heading_);
-  param_loader.loadParam("model/heading/n_inputs", _mpc_n_inputs_heading_);
-  param_loader.loadMatrixStatic("model/heading/A", _A_heading_, _mpc_n_states_heading_, _mpc_n_states_heading_);
-  param_loader.loadMatrixStatic("model/heading/B", _B_heading_, _mpc_n_states_heading_, _mpc_n_inputs_heading_);
-
   A_heading_ = _A_heading_;
   B_heading_ = _B_heading_;
 
-  // load the MPC parameters
-  param_loader.loadParam("mpc_solver/horizon_len", _mpc_horizon_len_);
-
   param_loader.loadParam("mpc_solver/dt2", _dt2_);
 
+  std::vector<double> dt_schedule;
+  param_loader.loadParam("mpc_solver/dt_schedule", dt_schedule, std::vector<double>());
+
+  // the first sample is always one MPC period ahead, the others follow either the schedule or dt2
+  if (!dt_schedule.empty() && int(dt_schedule.size()) != _mpc_horizon_len_ - 1) {
+    ROS_ERROR("[MpcTracker]: mpc_solver/dt_schedule has to be empty or have horizon_len - 1 = %d entries", _mpc_horizon_len_ - 1);
+    ros::shutdown();
+    return;
+  }
+
+  sample_dt_.resize(_mpc_horizon_len_);
+  sample_time_.resize(_mpc_horizon_len_);
+
+  for (int i = 0; i < _mpc_horizon_len_; i++) {
+
+    if (i == 0) {
+      sample_dt_[i] = _dt1_;
+    } else if (!dt_schedule.empty()) {
+      sample_dt_[i] = dt_schedule[i - 1];
+    } else {
+      sample_dt_[i] = _dt2_;
+    }
+
+    if (sample_dt_[i] <= 0) {
+      ROS_ERROR("[MpcTracker]: the sample spacing of the horizon has to be positive");
+      ros::shutdown();
+      return;
+    }
+
+    sample_time_[i] = (i == 0 ? 0 : sample_time_[i - 1]) + sample_dt_[i];
+  }
+
+  // the braking checks the reference at the same relative positions as with the default 40 samples horizon
+  _braking_idx_near_         = int(std::round(0.2 * _mpc_horizon_len_));
+  _braking_idx_near_heading_ = int(std::round(0.25 * _mpc_horizon_len_));
+  _braking_idx_far_          = int(std::round(0.75 * _mpc_horizon_len_));
+
   param_loader.loadParam("diagnostics/rate", _diagnostics_rate_);
   param_loader.loadParam("diagnostics/position_tracking_threshold", _diag_pos_tracking_thr_);
   param_loader.loadParam("diagnostics/orientation_tracking_threshold", _diag_heading_tracking_thr_);
 
+  double steady_state_tolerance;
+
   bool verbose_xy      = false;
   bool verbose_z       = false;
   bool verbose_heading = false;
@@ -441,6 +673,23 @@ void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] c
   std::vector<double> z_Q;
   std::vector<double> heading_Q;
 
+  param_loader.loadParam("mpc_solver/warm_start", drs_params_.warm_start);
+  param_loader.loadParam("mpc_solver/parallel", _parallel_solvers_);
+  param_loader.loadParam("mpc_solver/time_budget", _solver_time_budget_);
+  param_loader.loadParam("mpc_solver/steady_state_tolerance", steady_state_tolerance);
+
+  param_loader.loadParam("mpc_loop/realtime_thread", _mpc_realtime_thread_);
+  param_loader.loadParam("mpc_loop/priority", _mpc_thread_priority_);
+  param_loader.loadParam("mpc_loop/cpu", _mpc_thread_cpu_);
+  param_loader.loadParam("mpc_loop/lock_memory", _mpc_lock_memory_);
+
+  param_loader.loadParam("trajectory_library/path", _trajectory_library_path_);
+
+  if (_solver_time_budget_ <= 0.0 || _solver_time_budget_ > 1.0) {
+    ROS_ERROR("[MpcTracker]: mpc_solver/time_budget should be in (0, 1]");
+    ros::shutdown();
+  }
+
   param_loader.loadParam("mpc_solver/xy/verbose", verbose_xy);
   param_loader.loadParam("mpc_solver/xy/max_n_iterations", _max_iters_xy_);
   param_loader.loadParam("mpc_solver/xy/Q", xy_Q);
@@ -471,35 +720,54 @@ void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] c
   param_loader.loadParam("collision_avoidance/collision_slow_down_start", _avoidance_collision_slow_down_);
   param_loader.loadParam("collision_avoidance/collision_start_climbing", _avoidance_collision_start_climbing_);
   param_loader.loadParam("collision_avoidance/trajectory_timeout", _collision_trajectory_timeout_);
+  param_loader.loadParam("collision_avoidance/transform_validity", _avoidance_transform_validity_);
 
   if (!param_loader.loadedSuccessfully()) {
     ROS_ERROR("[MpcTracker]: could not load all parameters!");
     ros::shutdown();
   }
 
-  mpc_solver_x_       = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_xy, _max_iters_xy_, xy_Q, _dt1_, _dt2_, 0);
-  mpc_solver_y_       = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_xy, _max_iters_xy_, xy_Q, _dt1_, _dt2_, 1);
-  mpc_solver_z_       = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_z, _max_iters_z_, z_Q, _dt1_, _dt2_, 2);
-  mpc_solver_heading_ = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_heading, _max_iters_heading_, heading_Q, _dt1_, _dt2_, 0);
+  mpc_solver_x_       = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_xy, _max_iters_xy_, xy_Q, sample_dt_, 0);
+  mpc_solver_y_       = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_xy, _max_iters_xy_, xy_Q, sample_dt_, 1);
+  mpc_solver_z_       = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_z, _max_iters_z_, z_Q, sample_dt_, 2);
+  mpc_solver_heading_ = std::make_shared<mrs_mpc_solvers::mpc_tracker::Solver>("MpcTracker", verbose_heading, _max_iters_heading_, heading_Q, sample_dt_, 0);
+
+  mpc_solver_x_->setSteadyStateTolerance(steady_state_tolerance);
+  mpc_solver_y_->setSteadyStateTolerance(steady_state_tolerance);
+  mpc_solver_z_->setSteadyStateTolerance(steady_state_tolerance);
+  mpc_solver_heading_->setSteadyStateTolerance(steady_state_tolerance);
 
-  mpc_x_         = MatrixXd::Zero(_mpc_n_states_, 1);
-  mpc_x_heading_ = MatrixXd::Zero(_mpc_n_states_heading_, 1);
+  // two axes are solved at once, the MPC thread takes one of them
+  if (_parallel_solvers_) {
+    solver_pool_ = std::make_unique<WorkerPool>(1);
+  }
 
-  mpc_u_ = VectorXd::Zero(_mpc_m_states_);
+  mpc_x_.store({mpc_state_t::Zero(), mpc_state_heading_t::Zero()});
+  mpc_u_.store({mpc_input_t::Zero(), 0.0});
 
   coef_time = ros::Time(0);
 
-  des_x_trajectory_       = MatrixXd::Zero(_mpc_horizon_len_, 1);
-  des_y_trajectory_       = MatrixXd::Zero(_mpc_horizon_len_, 1);
-  des_z_trajectory_       = MatrixXd::Zero(_mpc_horizon_len_, 1);
-  des_z_filtered_offset_  = MatrixXd::Zero(_mpc_horizon_len_, 1);
-  des_heading_trajectory_ = MatrixXd::Zero(_mpc_horizon_len_, 1);
+  des_x_trajectory_       = mpc_horizon_t::Zero(_mpc_horizon_len_);
+  des_y_trajectory_       = mpc_horizon_t::Zero(_mpc_horizon_len_);
+  des_z_trajectory_       = mpc_horizon_t::Zero(_mpc_horizon_len_);
+  des_z_filtered_offset_  = mpc_horizon_t::Zero(_mpc_horizon_len_);
+  des_heading_trajectory_ = mpc_horizon_t::Zero(_mpc_horizon_len_);
 
   service_client_wiggle_ = nh_.advertiseService("wiggle_in", &MpcTracker::callbackWiggle, this);
 
+  service_server_splice_trajectory_ = nh_.advertiseService("trajectory_splice_in", &MpcTracker::callbackSpliceTrajectory, this);
+
+  service_server_trajectory_library_ = nh_.advertiseService("trajectory_library_in", &MpcTracker::callbackTrajectoryLibrary, this);
+
   pub_diagnostics_   = nh_.advertise<mrs_msgs::MpcTrackerDiagnostics>("diagnostics_out", 1);
   pub_status_string_ = nh_.advertise<std_msgs::String>("string_out", 1);
 
+  pub_solver_iterations_ = nh_.advertise<std_msgs::Int32MultiArray>("solver_iterations_out", 1);
+  pub_solver_status_     = nh_.advertise<std_msgs::Int32MultiArray>("solver_status_out", 1);
+  pub_mpc_loop_jitter_   = nh_.advertise<std_msgs::Float64MultiArray>("mpc_loop_jitter_out", 1);
+
+  pub_avoidance_transform_cache_ = nh_.advertise<std_msgs::Float64MultiArray>("avoidance_transform_cache_out", 1);
+
   // extract the numerical name
   sscanf(_uav_name_.c_str(), "uav%d", &avoidance_this_uav_number_);
   ROS_INFO("[MpcTracker]: Numerical ID of this UAV is %d", avoidance_this_uav_number_);
@@ -533,8 +801,8 @@ void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] c
   pub_debug_processed_trajectory_markers_ = nh_.advertise<visualization_msgs::MarkerArray>("trajectory_processed/markers_out", 1, true);
 
   // preallocate predicted trajectory
-  predicted_trajectory_         = MatrixXd::Zero(_mpc_horizon_len_ * _mpc_n_states_, 1);
-  predicted_heading_trajectory_ = MatrixXd::Zero(_mpc_horizon_len_ * _mpc_n_states_, 1);
+  predicted_trajectory_         = mpc_prediction_t::Zero(_mpc_horizon_len_ * MPC_N_STATES);
+  predicted_heading_trajectory_ = mpc_prediction_t::Zero(_mpc_horizon_len_ * MPC_N_STATES);
 
   collision_free_altitude_ = common_handlers_->safety_area.getMinHeight();
 
@@ -550,6 +818,13 @@ void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] c
   shopts.queue_size         = 10;
   shopts.transport_hints    = ros::TransportHints().tcpNoDelay();
 
+  // the names are resolved to the slots once, the callbacks get the index of their slot
+  other_uavs_ = std::vector<OtherUav_t>(_avoidance_other_uav_names_.size());
+
+  for (int i = 0; i < int(_avoidance_other_uav_names_.size()); i++) {
+    other_uavs_[i].name = _avoidance_other_uav_names_[i];
+  }
+
   // create subscribers on other drones diagnostics
   for (int i = 0; i < int(_avoidance_other_uav_names_.size()); i++) {
 
@@ -558,13 +833,13 @@ void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] c
 
     ROS_INFO("[MpcTracker]: subscribing to %s", prediction_topic_name.c_str());
 
-    other_uav_trajectory_subscribers_.push_back(
-        mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>(shopts, prediction_topic_name, &MpcTracker::callbackOtherMavTrajectory, this));
+    other_uav_trajectory_subscribers_.push_back(mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>(
+        shopts, prediction_topic_name, [this, i](mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>& sh_ptr) { callbackOtherMavTrajectory(sh_ptr, i); }));
 
     ROS_INFO("[MpcTracker]: subscribing to %s", diag_topic_name.c_str());
 
-    other_uav_diag_subscribers_.push_back(
-        mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>(shopts, diag_topic_name, &MpcTracker::callbackOtherMavDiagnostics, this));
+    other_uav_diag_subscribers_.push_back(mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>(
+        shopts, diag_topic_name, [this, i](mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>& sh_ptr) { callbackOtherMavDiagnostics(sh_ptr, i); }));
   }
 
   // | --------------- dynamic reconfigure server --------------- |
@@ -582,14 +857,61 @@ void MpcTracker::initialize(const ros::NodeHandle& parent_nh, [[maybe_unused]] c
 
   timer_avoidance_trajectory_ = nh_.createTimer(ros::Rate(_avoidance_trajectory_rate_), &MpcTracker::timerAvoidanceTrajectory, this);
   timer_diagnostics_          = nh_.createTimer(ros::Rate(_diagnostics_rate_), &MpcTracker::timerDiagnostics, this);
-  timer_mpc_iteration_        = nh_.createTimer(ros::Rate(_mpc_rate_), &MpcTracker::timerMPC, this);
-  timer_trajectory_tracking_  = nh_.createTimer(ros::Rate(1.0), &MpcTracker::timerTrajectoryTracking, this, false, false);
   timer_hover_                = nh_.createTimer(ros::Rate(10.0), &MpcTracker::timerHover, this, false, false);
 
+  // the thread sleeps on the monotonic clock, it would not follow the simulated time (paused or faster than real time)
+  if (_mpc_realtime_thread_ && ros::Time::isSimTime()) {
+    ROS_WARN("[MpcTracker]: the node uses the simulated time, the MPC runs on a ROS timer instead of the realtime thread");
+    _mpc_realtime_thread_ = false;
+  }
+
+  if (!_mpc_realtime_thread_) {
+    timer_mpc_iteration_ = nh_.createTimer(ros::Rate(_mpc_rate_), &MpcTracker::timerMPC, this);
+  }
+
+  // | ------------------ realtime MPC thread ------------------- |
+
+  if (_mpc_realtime_thread_) {
+
+    // locks the memory of the whole process, not just of the tracker:
+    // 1. the current memory is faulted in and locked (MCL_CURRENT),
+    // 2. the future mappings are locked only as they are faulted in (MCL_FUTURE | MCL_ONFAULT), so mapping a trajectory library file does not
+    //    read the whole file, only the pages which are tracked stay in the memory
+    // a kernel without MCL_ONFAULT (< 4.4) keeps just the current memory locked, MCL_FUTURE alone would read every mapped library
+    if (_mpc_lock_memory_) {
+
+      if (mlockall(MCL_CURRENT) != 0) {
+        ROS_WARN("[MpcTracker]: could not lock the memory: %s", std::strerror(errno));
+      } else if (mlockall(MCL_FUTURE | MCL_ONFAULT) != 0) {
+        ROS_WARN("[MpcTracker]: the current memory is locked, the future memory is not: %s", std::strerror(errno));
+      }
+    }
+
+    mpc_loop_ = std::make_unique<RealtimeLoop>("mpc_loop", _dt1_, [this](const double lateness) { realtimeMPC(lateness); });
+
+    std::string message;
+
+    if (!mpc_loop_->setPriority(_mpc_thread_priority_, message) || !mpc_loop_->setAffinity(_mpc_thread_cpu_, message)) {
+      ROS_ERROR("[MpcTracker]: %s", message.c_str());
+      ros::shutdown();
+    }
+  }
+
   // | ----------------------- finish init ---------------------- |
 
   is_initialized_ = true;
 
+  if (mpc_loop_) {
+
+    std::string message;
+
+    if (!mpc_loop_->start(message)) {
+      ROS_WARN("[MpcTracker]: the MPC thread runs with the default scheduling, %s", message.c_str());
+    }
+
+    ROS_INFO("[MpcTracker]: the MPC runs on a dedicated thread, priority %d, cpu %d", _mpc_thread_priority_, _mpc_thread_cpu_);
+  }
+
   ROS_INFO("[MpcTracker]: initialized, version %s", VERSION);
 }
 
@@ -622,8 +944,8 @@ std::tuple<bool, std::string> MpcTracker::activate(const mrs_msgs::PositionComma
     return std::tuple(false, ss.str());
   }
 
-  MatrixXd mpc_x         = MatrixXd::Zero(_mpc_n_states_, 1);
-  MatrixXd mpc_x_heading = MatrixXd::Zero(_mpc_n_states_heading_, 1);
+  mpc_state_t         mpc_x         = mpc_state_t::Zero();
+  mpc_state_heading_t mpc_x_heading = mpc_state_heading_t::Zero();
 
   if (mrs_msgs::PositionCommand::Ptr() != last_position_cmd) {
 
@@ -726,14 +1048,11 @@ std::tuple<bool, std::string> MpcTracker::activate(const mrs_msgs::PositionComma
   {
     std::scoped_lock lock(mutex_mpc_x_);
 
-    mpc_x_         = mpc_x;
-    mpc_x_heading_ = mpc_x_heading;
+    mpc_x_.store({mpc_x, mpc_x_heading});
   }
 
   trajectory_tracking_in_progress_ = false;
 
-  timer_trajectory_tracking_.stop();
-
   mpc_start_time_  = ros::Time::now();
   mpc_total_delay_ = 0;
 
@@ -748,6 +1067,7 @@ std::tuple<bool, std::string> MpcTracker::activate(const mrs_msgs::PositionComma
   toggleHover(true);
 
   model_first_iteration_ = true;
+  mpc_warm_start_reset_  = true;
 
   A_ = _A_;
   B_ = _B_;
@@ -772,13 +1092,10 @@ void MpcTracker::deactivate(void) {
   trajectory_tracking_in_progress_ = false;
   model_first_iteration_           = true;
 
-  timer_trajectory_tracking_.stop();
-
   {
     std::scoped_lock lock(mutex_trajectory_tracking_states_);
 
-    trajectory_tracking_idx_     = 0;
-    trajectory_tracking_sub_idx_ = 0;
+    trajectory_tracking_time_ = 0;
   }
 
   ROS_INFO("[MpcTracker]: deactivated");
@@ -821,29 +1138,20 @@ bool MpcTracker::resetStatic(void) {
 
     ROS_INFO("[MpcTracker]: reseting with uav state with no dynamics");
 
-    mpc_x_(0, 0) = uav_state.pose.position.x;
-    mpc_x_(1, 0) = 0;
-    mpc_x_(2, 0) = 0;
-    mpc_x_(3, 0) = 0;
+    ModelState_t model_state;
 
-    mpc_x_(4, 0) = uav_state.pose.position.y;
-    mpc_x_(5, 0) = 0;
-    mpc_x_(6, 0) = 0;
-    mpc_x_(7, 0) = 0;
+    model_state.x = mpc_state_t::Zero();
 
-    mpc_x_(8, 0)  = uav_state.pose.position.z;
-    mpc_x_(9, 0)  = 0;
-    mpc_x_(10, 0) = 0;
-    mpc_x_(11, 0) = 0;
+    model_state.x(0, 0) = uav_state.pose.position.x;
+    model_state.x(4, 0) = uav_state.pose.position.y;
+    model_state.x(8, 0) = uav_state.pose.position.z;
 
-    mpc_x_heading_(0, 0) = uav_state_heading;
-    mpc_x_heading_(1, 0) = 0;
-    mpc_x_heading_(2, 0) = 0;
-    mpc_x_heading_(3, 0) = 0;
+    model_state.heading       = mpc_state_heading_t::Zero();
+    model_state.heading(0, 0) = uav_state_heading;
 
-    trajectory_tracking_in_progress_ = false;
+    mpc_x_.store(model_state);
 
-    timer_trajectory_tracking_.stop();
+    trajectory_tracking_in_progress_ = false;
 
     mpc_start_time_  = ros::Time::now();
     mpc_total_delay_ = 0;
@@ -933,7 +1241,7 @@ const mrs_msgs::PositionCommand::ConstPtr MpcTracker::update(const mrs_msgs::Uav
 
   iterateModel();
 
-  auto [mpc_x, mpc_x_heading] = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_, mpc_x_heading_);
+  auto [mpc_x, mpc_x_heading] = mpc_x_.load();
 
   // chech wheather all outputs are finite
   bool arefinite = true;
@@ -1027,9 +1335,13 @@ const mrs_msgs::PositionCommand::ConstPtr MpcTracker::update(const mrs_msgs::Uav
 
 const mrs_msgs::TrackerStatus MpcTracker::getStatus() {
 
-  auto [mpc_x, mpc_x_heading]  = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_, mpc_x_heading_);
+  auto [mpc_x, mpc_x_heading]  = mpc_x_.load();
   auto trajectory_size         = mrs_lib::get_mutexed(mutex_des_trajectory_, trajectory_size_);
-  auto trajectory_tracking_idx = mrs_lib::get_mutexed(mutex_trajectory_tracking_states_, trajectory_tracking_idx_);
+  auto trajectory_tracking_time = mrs_lib::get_mutexed(mutex_trajectory_tracking_states_, trajectory_tracking_time_);
+
+  auto whole_trajectory = std::atomic_load(&whole_trajectory_);
+
+  const int trajectory_tracking_idx = whole_trajectory ? whole_trajectory->index(trajectory_tracking_time) : 0;
 
   double des_x, des_y, des_z, des_heading;
   {
@@ -1057,19 +1369,24 @@ const mrs_msgs::TrackerStatus MpcTracker::getStatus() {
   tracker_status.trajectory_length = trajectory_size;
   tracker_status.trajectory_idx    = trajectory_tracking_idx;
 
-  if (trajectory_tracking_in_progress_) {
+  if (trajectory_tracking_in_progress_ && whole_trajectory) {
 
     auto uav_state = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
 
-    std::scoped_lock lock(mutex_des_whole_trajectory_);
-
     tracker_status.trajectory_reference.header.stamp    = ros::Time::now();
     tracker_status.trajectory_reference.header.frame_id = uav_state.header.frame_id;
 
-    tracker_status.trajectory_reference.reference.position.x = (*des_x_whole_trajectory_)(trajectory_tracking_idx);
-    tracker_status.trajectory_reference.reference.position.y = (*des_y_whole_trajectory_)(trajectory_tracking_idx);
-    tracker_status.trajectory_reference.reference.position.z = (*des_z_whole_trajectory_)(trajectory_tracking_idx);
-    tracker_status.trajectory_reference.reference.heading    = (*des_heading_whole_trajectory_)(trajectory_tracking_idx);
+    // the status follows the tracking, so the cursor moves forward by a few points between the calls
+    int status_cursor = status_trajectory_cursor_;
+
+    const Eigen::Vector4d reference = whole_trajectory->point(trajectory_tracking_idx, status_cursor);
+
+    status_trajectory_cursor_ = status_cursor;
+
+    tracker_status.trajectory_reference.reference.position.x = reference(0);
+    tracker_status.trajectory_reference.reference.position.y = reference(1);
+    tracker_status.trajectory_reference.reference.position.z = reference(2);
+    tracker_status.trajectory_reference.reference.heading    = reference(3);
 
     // | ---------- publish the current trajectory point ---------- |
 
@@ -1077,11 +1394,11 @@ const mrs_msgs::TrackerStatus MpcTracker::getStatus() {
     debug_trajectory_point.header.stamp    = ros::Time::now();
     debug_trajectory_point.header.frame_id = uav_state_.header.frame_id;
 
-    debug_trajectory_point.pose.position.x = (*des_x_whole_trajectory_)(trajectory_tracking_idx);
-    debug_trajectory_point.pose.position.y = (*des_y_whole_trajectory_)(trajectory_tracking_idx);
-    debug_trajectory_point.pose.position.z = (*des_z_whole_trajectory_)(trajectory_tracking_idx);
+    debug_trajectory_point.pose.position.x = reference(0);
+    debug_trajectory_point.pose.position.y = reference(1);
+    debug_trajectory_point.pose.position.z = reference(2);
 
-    debug_trajectory_point.pose.orientation = mrs_lib::AttitudeConverter(0, 0, (*des_heading_whole_trajectory_)(trajectory_tracking_idx));
+    debug_trajectory_point.pose.orientation = mrs_lib::AttitudeConverter(0, 0, reference(3));
 
     try {
       publisher_current_trajectory_point_.publish(debug_trajectory_point);
@@ -1127,8 +1444,9 @@ const std_srvs::TriggerResponse::ConstPtr MpcTracker::switchOdometrySource(const
 
   odometry_reset_in_progress_ = true;
   mpc_result_invalid_         = true;
+  mpc_warm_start_reset_       = true;
 
-  auto x         = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_);
+  auto x         = mpc_x_.load().x;
   auto uav_state = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
 
   ROS_INFO(
@@ -1139,6 +1457,11 @@ const std_srvs::TriggerResponse::ConstPtr MpcTracker::switchOdometrySource(const
       new_uav_state->acceleration.linear.x, new_uav_state->acceleration.linear.y, new_uav_state->acceleration.linear.z);
 
   timer_mpc_iteration_.stop();
+
+  if (mpc_loop_) {
+    mpc_loop_->pause();
+  }
+
   ROS_INFO("[MpcTracker]: mpc timer stopped");
 
   while (mpc_timer_running_) {
@@ -1192,20 +1515,36 @@ const std_srvs::TriggerResponse::ConstPtr MpcTracker::switchOdometrySource(const
   ROS_INFO("[MpcTracker]: dx %f dy %f dz %f dheading %f", dx, dy, dz, dheading);
 
   {
-    std::scoped_lock lock(mutex_mpc_x_, mutex_des_trajectory_, mutex_des_whole_trajectory_, mutex_uav_state_);
+    std::scoped_lock lock(mutex_mpc_x_, mutex_des_trajectory_, mutex_uav_state_);
 
-    if (trajectory_set_) {
+    ModelState_t model_state = mpc_x_.load();
 
-      for (int i = 0; i < trajectory_size_ + _mpc_horizon_len_; i++) {
+    Eigen::Map<mpc_state_t>         mpc_x         = model_state.x.map();
+    Eigen::Map<mpc_state_heading_t> mpc_x_heading = model_state.heading.map();
 
-        Eigen::Vector2d temp_vec((*des_x_whole_trajectory_)(i)-uav_state_.pose.position.x, (*des_y_whole_trajectory_)(i)-uav_state_.pose.position.y);
-        temp_vec = Eigen::Rotation2D<double>(dheading).toRotationMatrix() * temp_vec;
+    auto whole_trajectory = std::atomic_load(&whole_trajectory_);
 
-        (*des_x_whole_trajectory_)(i) = new_uav_state->pose.position.x + temp_vec[0];
-        (*des_y_whole_trajectory_)(i) = new_uav_state->pose.position.y + temp_vec[1];
-        (*des_z_whole_trajectory_)(i) += dz;
-        (*des_heading_whole_trajectory_)(i) += dheading;
-      }
+    if (trajectory_set_ && whole_trajectory) {
+
+      // the snapshot is immutable, the transformed trajectory is published as a new one
+      auto transformed_trajectory = std::make_shared<TrajectorySnapshot_t>(*whole_trajectory);
+
+      // rotate the horizontal position around the old UAV position and move it to the new one, shift the height and the heading
+      const Eigen::Vector2d old_position(uav_state_.pose.position.x, uav_state_.pose.position.y);
+      const Eigen::Vector2d new_position(new_uav_state->pose.position.x, new_uav_state->pose.position.y);
+      const Eigen::Matrix2d rotation = Eigen::Rotation2D<double>(dheading).toRotationMatrix();
+      const Eigen::Vector2d shift(dz, dheading);
+
+      TrajectoryFrame_t odometry_switch;
+
+      odometry_switch.rotation    = rotation;
+      odometry_switch.translation = new_position - rotation * old_position;
+      odometry_switch.shift       = shift;
+
+      // only the frame of the snapshot changes, the points (possibly of a mapped file) are shared with the old one
+      transformed_trajectory->frame = transformed_trajectory->frame.then(odometry_switch);
+
+      std::atomic_store(&whole_trajectory_, std::shared_ptr<const TrajectorySnapshot_t>(transformed_trajectory));
     }
 
     for (int i = 0; i < _mpc_horizon_len_; i++) {
@@ -1223,30 +1562,32 @@ const std_srvs::TriggerResponse::ConstPtr MpcTracker::switchOdometrySource(const
 
     // update the position
     {
-      Eigen::Vector2d temp_vec(mpc_x_(0, 0) - uav_state_.pose.position.x, mpc_x_(4, 0) - uav_state_.pose.position.y);
-      temp_vec     = Eigen::Rotation2D<double>(dheading).toRotationMatrix() * temp_vec;
-      mpc_x_(0, 0) = new_uav_state->pose.position.x + temp_vec[0];
-      mpc_x_(4, 0) = new_uav_state->pose.position.y + temp_vec[1];
-      mpc_x_(8, 0) += dz;
+      Eigen::Vector2d temp_vec(mpc_x(0, 0) - uav_state_.pose.position.x, mpc_x(4, 0) - uav_state_.pose.position.y);
+      temp_vec    = Eigen::Rotation2D<double>(dheading).toRotationMatrix() * temp_vec;
+      mpc_x(0, 0) = new_uav_state->pose.position.x + temp_vec[0];
+      mpc_x(4, 0) = new_uav_state->pose.position.y + temp_vec[1];
+      mpc_x(8, 0) += dz;
     }
 
     // update the velocity
     {
-      mpc_x_(1, 0) = new_uav_state->velocity.linear.x;
-      mpc_x_(5, 0) = new_uav_state->velocity.linear.y;
+      mpc_x(1, 0) = new_uav_state->velocity.linear.x;
+      mpc_x(5, 0) = new_uav_state->velocity.linear.y;
       // we leave the z velocity as it was in the original frame
     }
 
     // update the acceleration
     {
-      mpc_x_(2, 0)  = 0;
-      mpc_x_(6, 0)  = 0;
-      mpc_x_(10, 0) = 0;
+      mpc_x(2, 0)  = 0;
+      mpc_x(6, 0)  = 0;
+      mpc_x(10, 0) = 0;
     }
 
     // update the heading and its derivative
-    mpc_x_heading_(0, 0) += dheading;
-    mpc_x_heading_(1, 0) = new_uav_state->velocity.angular.x;
+    mpc_x_heading(0, 0) += dheading;
+    mpc_x_heading(1, 0) = new_uav_state->velocity.angular.x;
+
+    mpc_x_.store(model_state);
   }
 
   ROS_INFO(
@@ -1256,6 +1597,18 @@ const std_srvs::TriggerResponse::ConstPtr MpcTracker::switchOdometrySource(const
   ROS_INFO("[MpcTracker]: starting the MPC timer");
   timer_mpc_iteration_.start();
 
+  if (mpc_loop_) {
+    mpc_loop_->resume();
+  }
+
+  // the frames moved with respect to the utm origin, the transforms looked up until now, even during the switch, are not valid
+  {
+    std::scoped_lock lock(mutex_transform_cache_);
+
+    transform_cache_.clear();
+    transform_cache_generation_++;
+  }
+
   odometry_reset_in_progress_ = false;
 
   return std_srvs::TriggerResponse::ConstPtr(new std_srvs::TriggerResponse(res));
@@ -1420,7 +1773,7 @@ const mrs_msgs::TrajectoryReferenceSrvResponse::ConstPtr MpcTracker::setTrajecto
 
 /* //{ callbackOtherMavTrajectory() */
 
-void MpcTracker::callbackOtherMavTrajectory(mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>& sh_ptr) {
+void MpcTracker::callbackOtherMavTrajectory(mrs_lib::SubscribeHandler<mrs_msgs::FutureTrajectory>& sh_ptr, const int index) {
 
   if (!is_initialized_) {
     return;
@@ -1430,13 +1783,10 @@ void MpcTracker::callbackOtherMavTrajectory(mrs_lib::SubscribeHandler<mrs_msgs::
 
   auto uav_state = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
 
-  mrs_msgs::FutureTrajectory trajectory = *sh_ptr.getMsg();
-
-  // the times might not be synchronized, so just remember the time of receiving it
-  trajectory.stamp = ros::Time::now();
+  const mrs_msgs::FutureTrajectory::ConstPtr trajectory = sh_ptr.getMsg();
 
   // transform it from the utm origin to the currently used frame
-  auto res = common_handlers_->transformer->getTransform("utm_origin", uav_state.header.frame_id, ros::Time::now(), true);
+  auto res = getAvoidanceTransform("utm_origin", uav_state.header.frame_id);
 
   if (!res) {
 
@@ -1447,60 +1797,61 @@ void MpcTracker::callbackOtherMavTrajectory(mrs_lib::SubscribeHandler<mrs_msgs::
     return;
   }
 
-  mrs_lib::TransformStamped tf = res.value();
+  const Eigen::Isometry3d transform = res.value();
 
-  for (int i = 0; i < int(trajectory.points.size()); i++) {
+  // the collision check tests only the points within our horizon
+  const int n_points = std::min(_mpc_horizon_len_, int(trajectory->points.size()));
 
-    geometry_msgs::PoseStamped original_pose;
+  // all the points are transformed at once
+  Eigen::Matrix<double, 3, Eigen::Dynamic, 0, 3, MPC_MAX_HORIZON_LEN> points(3, n_points);
 
-    original_pose.pose.position.x = trajectory.points[i].x;
-    original_pose.pose.position.y = trajectory.points[i].y;
-    original_pose.pose.position.z = trajectory.points[i].z;
+  for (int i = 0; i < n_points; i++) {
+    points.col(i) << trajectory->points[i].x, trajectory->points[i].y, trajectory->points[i].z;
+  }
 
-    original_pose.pose.orientation = mrs_lib::AttitudeConverter(0, 0, 0);
+  points = (transform.linear() * points).colwise() + transform.translation();
 
-    auto res = common_handlers_->transformer->transform(tf, original_pose);
+  OtherUavTrajectory_t other_uav_trajectory;
 
-    if (res) {
-      trajectory.points[i].x = res.value().pose.position.x;
-      trajectory.points[i].y = res.value().pose.position.y;
-      trajectory.points[i].z = res.value().pose.position.z;
-    } else {
+  // the times might not be synchronized, so just remember the time of receiving it
+  other_uav_trajectory.summary.stamp = ros::Time::now();
 
-      std::string message = "[MpcTracker]: could not transform point of other uav future trajectory!";
-      ROS_WARN_STREAM_ONCE(message);
-      ROS_DEBUG_STREAM_THROTTLE(1.0, message);
+  other_uav_trajectory.positions.map().topRows(n_points) = points.transpose();
+  other_uav_trajectory.n_points                          = n_points;
+  other_uav_trajectory.priority                          = trajectory->priority;
+  other_uav_trajectory.collision_avoidance               = trajectory->collision_avoidance;
 
-      return;
-    }
+  // the default box is empty, it intersects nothing
+  Eigen::AlignedBox3d box;
+
+  if (n_points > 0) {
+    box = Eigen::AlignedBox3d(points.rowwise().minCoeff(), points.rowwise().maxCoeff());
   }
 
-  {
-    std::scoped_lock lock(mutex_other_uav_avoidance_trajectories_);
+  other_uav_trajectory.summary.setBox(box);
 
-    // update the diagnostics
-    other_uav_avoidance_trajectories_[trajectory.uav_name] = trajectory;
-  }
+  // the slot is updated in place
+  other_uavs_[index].trajectory.store(other_uav_trajectory);
+  other_uavs_[index].summary.store(other_uav_trajectory.summary);
 }
 
 //}
 
 /* //{ callbackOtherMavDiagnostics() */
 
-void MpcTracker::callbackOtherMavDiagnostics(mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>& sh_ptr) {
+void MpcTracker::callbackOtherMavDiagnostics(mrs_lib::SubscribeHandler<mrs_msgs::MpcTrackerDiagnostics>& sh_ptr, const int index) {
 
   mrs_lib::Routine profiler_routine = profiler.createRoutine("callbackOtherMavDiagnostics");
 
-  std::scoped_lock lock(mutex_other_uav_diagnostics_);
-
-  mrs_msgs::MpcTrackerDiagnostics diagnostics = *sh_ptr.getMsg();
+  OtherUavDiagnostics_t diagnostics;
 
   // fill in the current time
   // the other uav's time might not be synchronized with ours
-  diagnostics.header.stamp = ros::Time::now();
+  diagnostics.stamp                      = ros::Time::now();
+  diagnostics.collision_avoidance_active = sh_ptr.getMsg()->collision_avoidance_active;
 
   // update the diagnostics
-  other_uav_diagnostics_[diagnostics.uav_name] = diagnostics;
+  other_uavs_[index].diagnostics.store(diagnostics);
 }
 
 //}
@@ -1521,6 +1872,48 @@ bool MpcTracker::callbackToggleCollisionAvoidance(std_srvs::SetBool::Request& re
 
 //}
 
+/* callbackSpliceTrajectory() //{ */
+
+bool MpcTracker::callbackSpliceTrajectory(mrs_msgs::TrajectoryReferenceSrv::Request& req, mrs_msgs::TrajectoryReferenceSrv::Response& res) {
+
+  if (!is_initialized_) {
+
+    res.success = false;
+    res.message = "tracker not initialized";
+    return true;
+  }
+
+  auto [success, message] = spliceTrajectory(req.trajectory);
+
+  res.success = success;
+  res.message = message;
+
+  return true;
+}
+
+//}
+
+/* callbackTrajectoryLibrary() //{ */
+
+bool MpcTracker::callbackTrajectoryLibrary(mrs_msgs::String::Request& req, mrs_msgs::String::Response& res) {
+
+  if (!is_initialized_) {
+
+    res.success = false;
+    res.message = "tracker not initialized";
+    return true;
+  }
+
+  auto [success, message] = loadLibraryTrajectory(req.value);
+
+  res.success = success;
+  res.message = message;
+
+  return true;
+}
+
+//}
+
 /* callbackWiggle() //{ */
 
 bool MpcTracker::callbackWiggle(std_srvs::SetBool::Request& req, std_srvs::SetBool::Response& res) {
@@ -1567,32 +1960,48 @@ void MpcTracker::dynamicReconfigureCallback(mrs_uav_trackers::mpc_trackerConfig&
 
 // | --------------- mutual collision avoidance --------------- |
 
-/* //{ checkCollision() */
+/* //{ getAvoidanceTransform() */
 
-double MpcTracker::checkCollision(const double ax, const double ay, const double az, const double bx, const double by, const double bz) {
+std::optional<Eigen::Isometry3d> MpcTracker::getAvoidanceTransform(const std::string& from, const std::string& to) {
 
-  if (mrs_lib::geometry::dist(vec2_t(ax, ay), vec2_t(bx, by)) < _avoidance_radius_threshold_ && fabs(az - bz) < _avoidance_height_threshold_) {
-    return true;
+  const ros::Time now = ros::Time::now();
 
-  } else {
+  unsigned long generation;
 
-    return false;
-  }
-}
+  {
+    std::scoped_lock lock(mutex_transform_cache_);
 
-//}
+    generation = transform_cache_generation_;
 
-/* //{ checkCollisionInflated() */
+    auto it = transform_cache_.find({from, to});
 
-double MpcTracker::checkCollisionInflated(const double ax, const double ay, const double az, const double bx, const double by, const double bz) {
+    if (it != transform_cache_.end() && (now - it->second.time).toSec() < _avoidance_transform_validity_) {
+      transform_cache_hits_++;
+      return it->second.transform;
+    }
 
-  if (mrs_lib::geometry::dist(vec2_t(ax, ay), vec2_t(bx, by)) < _avoidance_radius_threshold_ + 1.0 && fabs(az - bz) < _avoidance_height_threshold_ + 1.0) {
-    return true;
+    transform_cache_misses_++;
+  }
 
-  } else {
+  // the lookup is done unlocked, the other callers may use the cache meanwhile
+  auto res = common_handlers_->transformer->getTransform(from, to, now, true);
 
-    return false;
+  if (!res) {
+    return {};
+  }
+
+  const Eigen::Isometry3d transform = toIsometry(res.value().getTransform());
+
+  // the cache was cleared during the lookup, the transform may be from before the odometry switch, it is returned but not cached
+  {
+    std::scoped_lock lock(mutex_transform_cache_);
+
+    if (generation == transform_cache_generation_) {
+      transform_cache_[{from, to}] = CachedTransform_t{transform, now};
+    }
   }
+
+  return transform;
 }
 
 //}
@@ -1602,7 +2011,7 @@ double MpcTracker::checkCollisionInflated(const double ax, const double ay, cons
 // Check for potential collisions and return the needed altitude offset to avoid other drones
 double MpcTracker::checkTrajectoryForCollisions(int& first_collision_index) {
 
-  std::scoped_lock lock(mutex_predicted_trajectory_, mutex_des_trajectory_, mutex_other_uav_avoidance_trajectories_);
+  std::scoped_lock lock(mutex_predicted_trajectory_, mutex_des_trajectory_);
 
   first_collision_index = INT_MAX;
   avoiding_collision_   = false;
@@ -1611,33 +2020,59 @@ double MpcTracker::checkTrajectoryForCollisions(int& first_collision_index) {
   // collisons are irrelevant
   bool first_collision = true;
 
-  std::map<std::string, mrs_msgs::FutureTrajectory>::iterator u = other_uav_avoidance_trajectories_.begin();
+  // our predicted positions, gathered from the interleaved states once for all the UAVs
+  mpc_positions_t positions(_mpc_horizon_len_, 3);
+
+  for (int v = 0; v < _mpc_horizon_len_; v++) {
+    positions.row(v) << predicted_trajectory_(v * _mpc_n_states_, 0), predicted_trajectory_(v * _mpc_n_states_ + 4, 0),
+        predicted_trajectory_(v * _mpc_n_states_ + 8, 0);
+  }
+
+  // our prediction, grown by the inflated collision distances, a UAV whose box does not touch it can not collide at any point
+  const Eigen::AlignedBox3d box = inflatedBox(positions, _avoidance_radius_threshold_, _avoidance_height_threshold_);
+
+  mpc_horizon_array_t collision, collision_inflated;
 
-  while (u != other_uav_avoidance_trajectories_.end()) {
+  const ros::Time now = ros::Time::now();
+
+  for (const OtherUav_t& other_uav : other_uavs_) {
 
     first_collision = true;
 
-    // is the other's trajectory fresh enought?
-    if ((ros::Time::now() - u->second.stamp).toSec() < _collision_trajectory_timeout_) {
+    const OtherUavSummary_t summary = other_uav.summary.load();
+
+    // is the other's trajectory fresh enought and near enough?
+    if (!summary.stamp.isZero() && (now - summary.stamp).toSec() < _collision_trajectory_timeout_ && box.intersects(summary.box())) {
 
-      for (int v = 0; v < _mpc_horizon_len_; v++) {
+      // the trajectory may be newer than the summary, it is used as a whole
+      const OtherUavTrajectory_t  other_uav_trajectory = other_uav.trajectory.load();
+      const OtherUavTrajectory_t* u                    = &other_uav_trajectory;
+
+      // the other UAVs are expected to sample their prediction the same way, a shorter one is checked only as far as it goes
+      const int n_points = u->n_points;
+
+      collisionMargins(positions, *u, _avoidance_radius_threshold_, _avoidance_height_threshold_, collision, collision_inflated);
+
+      // a collision is within the inflated distances as well, most of the UAVs end here
+      const int n_tested = (n_points > 0 && collision_inflated.minCoeff() < 0) ? n_points : 0;
+
+      for (int v = 0; v < n_tested; v++) {
 
         // check all points of the trajectory for possible collisions
-        if (checkCollision(predicted_trajectory_(v * _mpc_n_states_, 0), predicted_trajectory_(v * _mpc_n_states_ + 4, 0),
-                           predicted_trajectory_(v * _mpc_n_states_ + 8, 0), u->second.points[v].x, u->second.points[v].y, u->second.points[v].z)) {
+        if (collision(v) < 0) {
 
           // collision is detected
           int other_uav_priority = INT_MAX;
           // get the priority of the other uav
           /* sscanf(u->first.c_str(), "uav%d", &other_uav_priority); */
-          other_uav_priority = u->second.priority;
+          other_uav_priority = u->priority;
 
           // check if we should be avoiding (out priority is higher, or the other uav has collision avoidance turned off)
-          if ((u->second.collision_avoidance == false) || (other_uav_priority < avoidance_this_uav_priority_)) {
+          if ((u->collision_avoidance == false) || (other_uav_priority < avoidance_this_uav_priority_)) {
 
             // we should be avoiding
             avoiding_collision_      = true;
-            double tmp_safe_altitude = u->second.points[v].z + _avoidance_height_correction_;
+            double tmp_safe_altitude = u->positions(v, 2) + _avoidance_height_correction_;
 
             if (tmp_safe_altitude > collision_free_altitude_ && v <= _avoidance_collision_start_climbing_) {
               collision_free_altitude_ = tmp_safe_altitude;
@@ -1652,8 +2087,7 @@ double MpcTracker::checkTrajectoryForCollisions(int& first_collision_index) {
           }
         }
 
-        if (checkCollisionInflated(predicted_trajectory_(v * _mpc_n_states_, 0), predicted_trajectory_(v * _mpc_n_states_ + 4, 0),
-                                   predicted_trajectory_(v * _mpc_n_states_ + 8, 0), u->second.points[v].x, u->second.points[v].y, u->second.points[v].z)) {
+        if (collision_inflated(v) < 0) {
 
           // collision is detected
           if (first_collision_index > v) {
@@ -1662,7 +2096,6 @@ double MpcTracker::checkTrajectoryForCollisions(int& first_collision_index) {
         }
       }
     }
-    u++;
   }
 
   if (!avoiding_collision_) {
@@ -1685,14 +2118,13 @@ double MpcTracker::checkTrajectoryForCollisions(int& first_collision_index) {
 
 /* //{ filterReferenceXY() */
 
-std::tuple<MatrixXd, MatrixXd> MpcTracker::filterReferenceXY(const VectorXd& des_x_trajectory, const VectorXd& des_y_trajectory, double max_speed_x,
-                                                             double max_speed_y) {
+std::tuple<mpc_horizon_t, mpc_horizon_t> MpcTracker::filterReferenceXY(const mpc_horizon_t& des_x_trajectory, const mpc_horizon_t& des_y_trajectory,
+                                                                       double max_speed_x, double max_speed_y) {
 
-  auto mpc_x         = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_);
-  auto trajectory_dt = mrs_lib::get_mutexed(mutex_des_trajectory_, trajectory_dt_);
+  auto mpc_x = mpc_x_.load().x;
 
-  MatrixXd filtered_x_trajectory = MatrixXd::Zero(_mpc_horizon_len_, 1);
-  MatrixXd filtered_y_trajectory = MatrixXd::Zero(_mpc_horizon_len_, 1);
+  mpc_horizon_t filtered_x_trajectory = mpc_horizon_t::Zero(_mpc_horizon_len_);
+  mpc_horizon_t filtered_y_trajectory = mpc_horizon_t::Zero(_mpc_horizon_len_);
 
   double difference_x;
   double difference_y;
@@ -1707,8 +2139,8 @@ std::tuple<MatrixXd, MatrixXd> MpcTracker::filterReferenceXY(const VectorXd& des
       difference_x = des_x_trajectory(i, 0) - mpc_x(0, 0);
       difference_y = des_y_trajectory(i, 0) - mpc_x(4, 0);
     } else {
-      max_sample_x = max_speed_x * _dt2_;
-      max_sample_y = max_speed_y * _dt2_;
+      max_sample_x = max_speed_x * sample_dt_[i];
+      max_sample_y = max_speed_y * sample_dt_[i];
       difference_x = des_x_trajectory(i, 0) - filtered_x_trajectory(i - 1, 0);
       difference_y = des_y_trajectory(i, 0) - filtered_y_trajectory(i - 1, 0);
     }
@@ -1751,9 +2183,10 @@ std::tuple<MatrixXd, MatrixXd> MpcTracker::filterReferenceXY(const VectorXd& des
 
   if (wiggle_enabled) {
 
+    // the phase follows the time of each sample of the horizon
     for (int i = 0; i < _mpc_horizon_len_; i++) {
-      filtered_x_trajectory(i, 0) += wiggle_amplitude * cos(wiggle_frequency_ * 2 * M_PI * i * trajectory_dt + wiggle_phase_);
-      filtered_y_trajectory(i, 0) += wiggle_amplitude * sin(wiggle_frequency_ * 2 * M_PI * i * trajectory_dt + wiggle_phase_);
+      filtered_x_trajectory(i, 0) += wiggle_amplitude * cos(wiggle_frequency_ * 2 * M_PI * sample_time_[i] + wiggle_phase_);
+      filtered_y_trajectory(i, 0) += wiggle_amplitude * sin(wiggle_frequency_ * 2 * M_PI * sample_time_[i] + wiggle_phase_);
     }
 
     wiggle_phase_ += wiggle_frequency_ * _dt1_ * 2 * M_PI;
@@ -1770,14 +2203,14 @@ std::tuple<MatrixXd, MatrixXd> MpcTracker::filterReferenceXY(const VectorXd& des
 
 /* //{ filterReferenceZ() */
 
-MatrixXd MpcTracker::filterReferenceZ(const VectorXd& des_z_trajectory, const double max_ascending_speed, const double max_descending_speed) {
+mpc_horizon_t MpcTracker::filterReferenceZ(const mpc_horizon_t& des_z_trajectory, const double max_ascending_speed, const double max_descending_speed) {
 
-  auto mpc_x = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_);
+  auto mpc_x = mpc_x_.load().x;
 
   double difference_z;
   double max_sample_z;
 
-  MatrixXd filtered_trajectory = MatrixXd::Zero(_mpc_horizon_len_, 1);
+  mpc_horizon_t filtered_trajectory = mpc_horizon_t::Zero(_mpc_horizon_len_);
 
   double current_z = mpc_x(8, 0);
 
@@ -1798,9 +2231,9 @@ MatrixXd MpcTracker::filterReferenceZ(const VectorXd& des_z_trajectory, const do
       difference_z = des_z_trajectory(i, 0) - filtered_trajectory(i - 1, 0);
 
       if (difference_z > 0) {
-        max_sample_z = max_ascending_speed * _dt2_;
+        max_sample_z = max_ascending_speed * sample_dt_[i];
       } else {
-        max_sample_z = max_descending_speed * _dt2_;
+        max_sample_z = max_descending_speed * sample_dt_[i];
       }
     }
 
@@ -1835,7 +2268,7 @@ void MpcTracker::manageConstraints() {
   }
 
   auto constraints            = mrs_lib::get_mutexed(mutex_constraints_, constraints_);
-  auto [mpc_x, mpc_x_heading] = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_, mpc_x_heading_);
+  auto [mpc_x, mpc_x_heading] = mpc_x_.load();
 
   bool can_change = (fabs(mpc_x(1, 0)) < constraints.horizontal_speed) && (fabs(mpc_x(2, 0)) < constraints.horizontal_acceleration) &&
                     (fabs(mpc_x(3, 0)) < constraints.horizontal_jerk) && (fabs(mpc_x(5, 0)) < constraints.horizontal_speed) &&
@@ -1878,16 +2311,44 @@ void MpcTracker::manageConstraints() {
 
 //}
 
+/* //{ runSolverTasks() */
+
+// runs the solver tasks on the worker pool, or one after another when the pool is disabled
+void MpcTracker::runSolverTasks(const std::function<void()>* tasks, const int n_tasks) {
+
+  if (solver_pool_) {
+
+    solver_pool_->run(tasks, n_tasks);
+
+  } else {
+
+    for (int i = 0; i < n_tasks; i++) {
+      tasks[i]();
+    }
+  }
+}
+
+//}
+
 /* //{ calculateMPC() */
 
 void MpcTracker::calculateMPC() {
 
   auto constraints            = mrs_lib::get_mutexed(mutex_constraints_filtered_, constraints_filtered_);
-  auto [mpc_x, mpc_x_heading] = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_, mpc_x_heading_);
-  auto uav_state              = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
+  auto estimator_type         = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_.estimator_horizontal.type);  // not the whole state, it has strings
   auto drs_params             = mrs_lib::get_mutexed(mutex_drs_params_, drs_params_);
 
-  MatrixXd des_x_trajectory, des_y_trajectory, des_z_trajectory, des_heading_trajectory;
+  // not a structured binding, those can not be captured by the solver lambdas
+  mpc_state_t         mpc_x;
+  mpc_state_heading_t mpc_x_heading;
+  {
+    const ModelState_t model_state = mpc_x_.load();
+
+    mpc_x         = model_state.x;
+    mpc_x_heading = model_state.heading;
+  }
+
+  mpc_horizon_t des_x_trajectory, des_y_trajectory, des_z_trajectory, des_heading_trajectory;
   {
     std::scoped_lock lock(mutex_des_trajectory_);
 
@@ -1900,8 +2361,7 @@ void MpcTracker::calculateMPC() {
   int    first_collision_index = INT_MAX;
   double lowest_z              = std::numeric_limits<double>::max();
 
-  if (collision_avoidance_enabled_ &&
-      (uav_state.estimator_horizontal.type == mrs_msgs::EstimatorType::GPS || uav_state.estimator_horizontal.type == mrs_msgs::EstimatorType::RTK)) {
+  if (collision_avoidance_enabled_ && (estimator_type == mrs_msgs::EstimatorType::GPS || estimator_type == mrs_msgs::EstimatorType::RTK)) {
 
     // determine the lowest point in our trajectory
     for (int i = 0; i < _mpc_horizon_len_; i++) {
@@ -1981,17 +2441,41 @@ void MpcTracker::calculateMPC() {
   }
 
   // First control input generated by MPC
-  VectorXd mpc_u         = VectorXd::Zero(_mpc_m_states_);
-  double   mpc_u_heading = 0;
+  mpc_input_t mpc_u         = mpc_input_t::Zero();
+  double      mpc_u_heading = 0;
 
   double iters_z       = 0;
   double iters_x       = 0;
   double iters_y       = 0;
   double iters_heading = 0;
 
+  mrs_mpc_solvers::mpc_tracker::SolverStatus_t status_x, status_y, status_z, status_heading;
+
+  // every solver gets an equal share of the time budget, two of them run at once when solving in parallel
+  const int  n_sequential_solves = solver_pool_ ? 2 : 4;
+  const auto solver_time_slot    = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(_solver_time_budget_ * _dt1_ / n_sequential_solves));
+
+  // | ----------------------- warm start ----------------------- |
+
+  mpc_solver_x_->setWarmStart(drs_params.warm_start);
+  mpc_solver_y_->setWarmStart(drs_params.warm_start);
+  mpc_solver_z_->setWarmStart(drs_params.warm_start);
+  mpc_solver_heading_->setWarmStart(drs_params.warm_start);
+
+  if (mpc_warm_start_reset_) {
+
+    mpc_solver_x_->resetWarmStart();
+    mpc_solver_y_->resetWarmStart();
+    mpc_solver_z_->resetWarmStart();
+    mpc_solver_heading_->resetWarmStart();
+
+    mpc_warm_start_reset_ = false;
+  }
+
   ros::Time time_begin = ros::Time::now();
 
-  MatrixXd des_z_filtered = filterReferenceZ(des_z_trajectory, max_speed_z, min_speed_z);
+  mpc_horizon_t des_z_filtered = filterReferenceZ(des_z_trajectory, max_speed_z, min_speed_z);
 
   for (int i = 0; i < _mpc_horizon_len_; i++) {
     if (des_z_filtered(i, 0) < minimum_collison_free_altitude_) {
@@ -2001,36 +2485,78 @@ void MpcTracker::calculateMPC() {
     }
   }
 
-  // | ----------------- prepare the references ----------------- |
+  // unwrap the heading reference
 
-  // | -------------------- MPC solver z-axis ------------------- |
+  des_heading_trajectory(0, 0) = sradians::unwrap(des_heading_trajectory(0, 0), mpc_x_heading(0));
 
-  if (brake_) {
-    mpc_solver_z_->setVelQ(drs_params.q_vel_braking);
-  } else {
-    mpc_solver_z_->setVelQ(drs_params.q_vel_no_braking);
+  for (int i = 1; i < _mpc_horizon_len_; i++) {
+    des_heading_trajectory(i, 0) = sradians::unwrap(des_heading_trajectory(i, 0), des_heading_trajectory(i - 1, 0));
   }
 
-  MatrixXd initial_z = MatrixXd::Zero(_mpc_n_states_, 1);
+  // | -------------------- MPC solver z-axis ------------------- |
+
+  auto solve_z = [&]() {
+    if (brake_) {
+      mpc_solver_z_->setVelQ(drs_params.q_vel_braking);
+    } else {
+      mpc_solver_z_->setVelQ(drs_params.q_vel_no_braking);
+    }
+
+    mpc_axis_state_t initial_z;
+
+    initial_z(0, 0) = mpc_x(8, 0);
+    initial_z(1, 0) = mpc_x(9, 0);
+    initial_z(2, 0) = mpc_x(10, 0);
+    initial_z(3, 0) = mpc_x(11, 0);
+
+    mpc_solver_z_->setInitialState(initial_z);
+    mpc_solver_z_->loadReference(des_z_filtered_offset_);
+    mpc_solver_z_->setLimits(max_speed_z, min_speed_z, max_acc_z, min_acc_z, max_jerk_z, min_jerk_z, max_snap_z, min_snap_z);
+    iters_z += mpc_solver_z_->solveMPC(std::chrono::steady_clock::now() + solver_time_slot);
+    status_z = mpc_solver_z_->getStatus();
+
+    {
+      std::scoped_lock lock(mutex_predicted_trajectory_);
+
+      mpc_solver_z_->getStates(predicted_trajectory_);
+    }
+
+    mpc_u(2) = mpc_solver_z_->getFirstControlInput();
+  };
+
+  // | ------------------- MPC solver heading ------------------- |
+
+  // the heading is independent of the translation, it can be solved together with the z-axis
+  auto solve_heading = [&]() {
+    if (brake_) {
+      mpc_solver_heading_->setVelQ(drs_params.q_vel_braking);
+    } else {
+      mpc_solver_heading_->setVelQ(drs_params.q_vel_no_braking);
+    }
+
+    mpc_solver_heading_->setInitialState(mpc_x_heading);
+    mpc_solver_heading_->loadReference(des_heading_trajectory);
+    mpc_solver_heading_->setLimits(constraints.heading_speed, constraints.heading_speed, constraints.heading_acceleration, constraints.heading_acceleration,
+                                   constraints.heading_jerk, constraints.heading_jerk, constraints.heading_snap, constraints.heading_snap);
+    iters_heading += mpc_solver_heading_->solveMPC(std::chrono::steady_clock::now() + solver_time_slot);
+    status_heading = mpc_solver_heading_->getStatus();
 
-  initial_z(0, 0) = mpc_x(8, 0);
-  initial_z(1, 0) = mpc_x(9, 0);
-  initial_z(2, 0) = mpc_x(10, 0);
-  initial_z(3, 0) = mpc_x(11, 0);
+    {
+      std::scoped_lock lock(mutex_predicted_trajectory_);
+
+      mpc_solver_heading_->getStates(predicted_heading_trajectory_);
+    }
 
-  mpc_solver_z_->setInitialState(initial_z);
-  mpc_solver_z_->loadReference(des_z_filtered_offset_);
-  mpc_solver_z_->setLimits(max_speed_z, min_speed_z, max_acc_z, min_acc_z, max_jerk_z, min_jerk_z, max_snap_z, min_snap_z);
-  iters_z += mpc_solver_z_->solveMPC();
+    mpc_u_heading = mpc_solver_heading_->getFirstControlInput();
+  };
 
   {
-    std::scoped_lock lock(mutex_predicted_trajectory_);
+    // wrapped by reference, so that std::function does not allocate
+    const std::function<void()> tasks[] = {std::ref(solve_z), std::ref(solve_heading)};
 
-    mpc_solver_z_->getStates(predicted_trajectory_);
+    runSolverTasks(tasks, 2);
   }
 
-  mpc_u(2) = mpc_solver_z_->getFirstControlInput();
-
   // If we are climbing to avoid a collision, reduce or arrest our horizontal velocity
   double ascend;
   {
@@ -2044,89 +2570,77 @@ void MpcTracker::calculateMPC() {
     max_speed_x = max_speed_x * (1.0 - ascend);
   }
 
-  auto [des_x_filtered, des_y_filtered] = filterReferenceXY(des_x_trajectory, des_y_trajectory, max_speed_x, max_speed_y);
-
-  // unwrap the heading reference
-
-  des_heading_trajectory(0, 0) = sradians::unwrap(des_heading_trajectory(0, 0), mpc_x_heading_(0));
-
-  for (int i = 1; i < _mpc_horizon_len_; i++) {
-    des_heading_trajectory(i, 0) = sradians::unwrap(des_heading_trajectory(i, 0), des_heading_trajectory(i - 1, 0));
-  }
+  mpc_horizon_t des_x_filtered, des_y_filtered;
+  std::tie(des_x_filtered, des_y_filtered) = filterReferenceXY(des_x_trajectory, des_y_trajectory, max_speed_x, max_speed_y);
 
   // | -------------------- MPC solver x-axis ------------------- |
 
-  if (brake_) {
-    mpc_solver_x_->setVelQ(drs_params.q_vel_braking);
-  } else {
-    mpc_solver_x_->setVelQ(drs_params.q_vel_no_braking);
-  }
+  auto solve_x = [&]() {
+    if (brake_) {
+      mpc_solver_x_->setVelQ(drs_params.q_vel_braking);
+    } else {
+      mpc_solver_x_->setVelQ(drs_params.q_vel_no_braking);
+    }
 
-  MatrixXd initial_x = MatrixXd::Zero(_mpc_n_states_, 1);
+    mpc_axis_state_t initial_x;
 
-  initial_x(0, 0) = mpc_x(0, 0);
-  initial_x(1, 0) = mpc_x(1, 0);
-  initial_x(2, 0) = mpc_x(2, 0);
-  initial_x(3, 0) = mpc_x(3, 0);
+    initial_x(0, 0) = mpc_x(0, 0);
+    initial_x(1, 0) = mpc_x(1, 0);
+    initial_x(2, 0) = mpc_x(2, 0);
+    initial_x(3, 0) = mpc_x(3, 0);
 
-  mpc_solver_x_->setInitialState(initial_x);
-  mpc_solver_x_->loadReference(des_x_filtered);
-  mpc_solver_x_->setLimits(max_speed_x, max_speed_x, max_acc_x, max_acc_x, max_jerk_x, max_jerk_x, max_snap_x, max_snap_x);
-  iters_x += mpc_solver_x_->solveMPC();
+    mpc_solver_x_->setInitialState(initial_x);
+    mpc_solver_x_->loadReference(des_x_filtered);
+    mpc_solver_x_->setLimits(max_speed_x, max_speed_x, max_acc_x, max_acc_x, max_jerk_x, max_jerk_x, max_snap_x, max_snap_x);
+    iters_x += mpc_solver_x_->solveMPC(std::chrono::steady_clock::now() + solver_time_slot);
+    status_x = mpc_solver_x_->getStatus();
 
-  {
-    std::scoped_lock lock(mutex_predicted_trajectory_);
+    {
+      std::scoped_lock lock(mutex_predicted_trajectory_);
 
-    mpc_solver_x_->getStates(predicted_trajectory_);
-  }
+      mpc_solver_x_->getStates(predicted_trajectory_);
+    }
 
-  mpc_u(0) = mpc_solver_x_->getFirstControlInput();
+    mpc_u(0) = mpc_solver_x_->getFirstControlInput();
+  };
 
   // | -------------------- MPC solver y-axis ------------------- |
 
-  if (brake_) {
-    mpc_solver_y_->setVelQ(drs_params.q_vel_braking);
-  } else {
-    mpc_solver_y_->setVelQ(drs_params.q_vel_no_braking);
-  }
+  auto solve_y = [&]() {
+    if (brake_) {
+      mpc_solver_y_->setVelQ(drs_params.q_vel_braking);
+    } else {
+      mpc_solver_y_->setVelQ(drs_params.q_vel_no_braking);
+    }
 
-  MatrixXd initial_y = MatrixXd::Zero(_mpc_n_states_, 1);
+    mpc_axis_state_t initial_y;
 
-  initial_y(0, 0) = mpc_x(4, 0);
-  initial_y(1, 0) = mpc_x(5, 0);
-  initial_y(2, 0) = mpc_x(6, 0);
-  initial_y(3, 0) = mpc_x(7, 0);
+    initial_y(0, 0) = mpc_x(4, 0);
+    initial_y(1, 0) = mpc_x(5, 0);
+    initial_y(2, 0) = mpc_x(6, 0);
+    initial_y(3, 0) = mpc_x(7, 0);
 
-  mpc_solver_y_->setInitialState(initial_y);
-  mpc_solver_y_->loadReference(des_y_filtered);
-  mpc_solver_y_->setLimits(max_speed_y, max_speed_y, max_acc_y, max_acc_y, max_jerk_y, max_jerk_y, max_snap_y, max_snap_y);
-  iters_y += mpc_solver_y_->solveMPC();
-  {
-    std::scoped_lock lock(mutex_predicted_trajectory_);
+    mpc_solver_y_->setInitialState(initial_y);
+    mpc_solver_y_->loadReference(des_y_filtered);
+    mpc_solver_y_->setLimits(max_speed_y, max_speed_y, max_acc_y, max_acc_y, max_jerk_y, max_jerk_y, max_snap_y, max_snap_y);
+    iters_y += mpc_solver_y_->solveMPC(std::chrono::steady_clock::now() + solver_time_slot);
+    status_y = mpc_solver_y_->getStatus();
 
-    mpc_solver_y_->getStates(predicted_trajectory_);
-  }
-  mpc_u(1) = mpc_solver_y_->getFirstControlInput();
+    {
+      std::scoped_lock lock(mutex_predicted_trajectory_);
 
-  // | ------------------- MPC solver heading ------------------- |
+      mpc_solver_y_->getStates(predicted_trajectory_);
+    }
 
-  if (brake_) {
-    mpc_solver_heading_->setVelQ(drs_params.q_vel_braking);
-  } else {
-    mpc_solver_heading_->setVelQ(drs_params.q_vel_no_braking);
-  }
+    mpc_u(1) = mpc_solver_y_->getFirstControlInput();
+  };
 
-  mpc_solver_heading_->setInitialState(mpc_x_heading);
-  mpc_solver_heading_->loadReference(des_heading_trajectory);
-  mpc_solver_heading_->setLimits(constraints.heading_speed, constraints.heading_speed, constraints.heading_acceleration, constraints.heading_acceleration,
-                                 constraints.heading_jerk, constraints.heading_jerk, constraints.heading_snap, constraints.heading_snap);
-  iters_heading += mpc_solver_heading_->solveMPC();
   {
-    std::scoped_lock lock(mutex_predicted_trajectory_);
+    // wrapped by reference, so that std::function does not allocate
+    const std::function<void()> tasks[] = {std::ref(solve_x), std::ref(solve_y)};
 
-    mpc_solver_heading_->getStates(predicted_heading_trajectory_);
+    runSolverTasks(tasks, 2);
   }
-  mpc_u_heading = mpc_solver_heading_->getFirstControlInput();
 
   {
     std::scoped_lock lock(mutex_constraints_);
@@ -2157,12 +2671,7 @@ void MpcTracker::calculateMPC() {
     }
   }
 
-  {
-    std::scoped_lock lock(mutex_mpc_u_);
-
-    mpc_u_         = mpc_u;
-    mpc_u_heading_ = mpc_u_heading;
-  }
+  mpc_u_.store({mpc_u, mpc_u_heading});
 
   double mpc_solver_time = (ros::Time::now() - time_begin).toSec();
   if (mpc_solver_time > _dt1_ || iters_x > _max_iters_xy_ || iters_y > _max_iters_xy_ || iters_z > _max_iters_z_ || iters_heading > _max_iters_heading_) {
@@ -2172,54 +2681,46 @@ void MpcTracker::calculateMPC() {
                                                                            << _max_iters_heading_);
   }
 
+  if (status_x == mrs_mpc_solvers::mpc_tracker::SOLVER_DEADLINE || status_y == mrs_mpc_solvers::mpc_tracker::SOLVER_DEADLINE ||
+      status_z == mrs_mpc_solvers::mpc_tracker::SOLVER_DEADLINE || status_heading == mrs_mpc_solvers::mpc_tracker::SOLVER_DEADLINE) {
+    ROS_WARN_THROTTLE(1.0, "[MpcTracker]: the solver time budget ran out, using the best iterate (status X: %d, Y: %d, Z: %d, heading: %d)", status_x,
+                      status_y, status_z, status_heading);
+  }
+
   future_was_predicted_ = true;
 
   // | ------------- breaking for the next iteration ------------ |
 
+  const int near = _braking_idx_near_;
+  const int far  = _braking_idx_far_;
+  const int last = _mpc_horizon_len_ - 1;
+
   if (drs_params.braking_enabled &&
-      (fabs(des_x_filtered(8) - des_x_filtered(_mpc_horizon_len_ - 1)) <= 1e-1 && fabs(des_x_filtered(30) - des_x_filtered(_mpc_horizon_len_ - 1)) <= 1e-1) &&
-      (fabs(des_y_filtered(8) - des_y_filtered(_mpc_horizon_len_ - 1)) <= 1e-1 && fabs(des_y_filtered(30) - des_y_filtered(_mpc_horizon_len_ - 1)) <= 1e-1) &&
-      (fabs(des_z_filtered(8) - des_z_filtered(_mpc_horizon_len_ - 1)) <= 1e-1 && fabs(des_z_filtered(30) - des_z_filtered(_mpc_horizon_len_ - 1)) <= 1e-1) &&
-      (radians::diff(des_heading_trajectory(10), des_heading_trajectory(_mpc_horizon_len_ - 1)) <= 0.1 &&
-       radians::diff(des_heading_trajectory(30), des_heading_trajectory(_mpc_horizon_len_ - 1)) <= 0.1)) {
+      (fabs(des_x_filtered(near) - des_x_filtered(last)) <= 1e-1 && fabs(des_x_filtered(far) - des_x_filtered(last)) <= 1e-1) &&
+      (fabs(des_y_filtered(near) - des_y_filtered(last)) <= 1e-1 && fabs(des_y_filtered(far) - des_y_filtered(last)) <= 1e-1) &&
+      (fabs(des_z_filtered(near) - des_z_filtered(last)) <= 1e-1 && fabs(des_z_filtered(far) - des_z_filtered(last)) <= 1e-1) &&
+      (radians::diff(des_heading_trajectory(_braking_idx_near_heading_), des_heading_trajectory(last)) <= 0.1 &&
+       radians::diff(des_heading_trajectory(far), des_heading_trajectory(last)) <= 0.1)) {
     brake_ = true;
   } else {
     brake_ = false;
   }
 
-  /* publish mpc reference //{ */
+  // | ------------- leave the data for the debugging ------------ |
 
   {
-    geometry_msgs::PoseArray debug_trajectory_out;
-    debug_trajectory_out.header.stamp    = ros::Time::now();
-    debug_trajectory_out.header.frame_id = uav_state_.header.frame_id;
-
-    {
-      std::scoped_lock lock(mutex_predicted_trajectory_);
-
-      for (int i = 0; i < _mpc_horizon_len_; i++) {
-
-        geometry_msgs::Pose new_pose;
+    MpcDebug_t mpc_debug;
 
-        new_pose.position.x = des_x_filtered(i, 0);
-        new_pose.position.y = des_y_filtered(i, 0);
-        new_pose.position.z = des_z_filtered(i, 0);
+    mpc_debug.reference_x       = des_x_filtered;
+    mpc_debug.reference_y       = des_y_filtered;
+    mpc_debug.reference_z       = des_z_filtered;
+    mpc_debug.reference_heading = des_heading_trajectory;
 
-        new_pose.orientation = mrs_lib::AttitudeConverter(0, 0, des_heading_trajectory(i));
+    mpc_debug.iterations = {int(iters_x), int(iters_y), int(iters_z), int(iters_heading)};
+    mpc_debug.status     = {status_x, status_y, status_z, status_heading};
 
-        debug_trajectory_out.poses.push_back(new_pose);
-      }
-    }
-
-    try {
-      publisher_mpc_reference_debugging_.publish(debug_trajectory_out);
-    }
-    catch (...) {
-      ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", publisher_mpc_reference_debugging_.getTopic().c_str());
-    }
+    mpc_debug_.store(mpc_debug);
   }
-
-  //}
 }
 
 //}
@@ -2292,12 +2793,18 @@ void MpcTracker::iterateModel(void) {
   }
 
   {
-    std::scoped_lock lock(mutex_mpc_x_, mutex_mpc_u_);
+    std::scoped_lock lock(mutex_mpc_x_);
 
-    mpc_x_         = A_ * mpc_x_ + B_ * mpc_u_;
-    mpc_x_heading_ = A_heading_ * mpc_x_heading_ + B_heading_ * mpc_u_heading_;
+    const ModelInput_t model_input = mpc_u_.load();
 
-    mpc_x_heading_(0) = sradians::wrap(mpc_x_heading_(0));
+    ModelState_t model_state = mpc_x_.load();
+
+    model_state.x       = A_ * model_state.x.map() + B_ * model_input.u.map();
+    model_state.heading = A_heading_ * model_state.heading.map() + B_heading_ * model_input.heading;
+
+    model_state.heading(0) = sradians::wrap(model_state.heading(0));
+
+    mpc_x_.store(model_state);
   }
 }
 
@@ -2308,11 +2815,7 @@ void MpcTracker::iterateModel(void) {
 /* //{ loadTrajectory() */
 
 // method for setting desired trajectory
-std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::TrajectoryReference msg) {
-
-  // copy the member variables
-  auto x         = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_);
-  auto uav_state = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
+std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::TrajectoryReference& msg) {
 
   std::stringstream ss;
 
@@ -2322,19 +2825,12 @@ std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::T
   if (msg.dt <= 1e-4) {
     trajectory_dt = 0.2;
     ROS_WARN_THROTTLE(10.0, "[MpcTracker]: the trajectory dt was not specified, assuming its the old 0.2 s");
-  } else if (msg.dt < _dt1_) {
-    trajectory_dt = 0.2;
-    ss << std::setprecision(3) << "the trajectory dt (" << msg.dt << " s) is too small (smaller than the tracker's internal step size: " << _dt1_ << " s)";
-    ROS_ERROR_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
-    return std::tuple(false, ss.str(), false);
   } else {
     trajectory_dt = msg.dt;
   }
 
   //}
 
-  int trajectory_size = msg.points.size();
-
   /* sanitize the time-ness of the trajectory //{ */
 
   int    trajectory_sample_offset    = 0;  // how many samples in past is the trajectory
@@ -2380,7 +2876,7 @@ std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::T
 
       // if the offset is larger than the number of points in the trajectory
       // the trajectory can not be used
-      if (trajectory_sample_offset >= trajectory_size) {
+      if (trajectory_sample_offset >= int(msg.points.size())) {
 
         ss << "trajectory timestamp is too old (time difference = " << trajectory_time_offset << ")";
         ROS_ERROR_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
@@ -2392,9 +2888,6 @@ std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::T
         // offset the start
         if (trajectory_time_offset >= trajectory_dt) {
 
-          // decrease the trajectory size
-          trajectory_size -= trajectory_sample_offset;
-
           ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: got trajectory with timestamp '" << trajectory_time_offset << " s' in the past");
 
         } else {
@@ -2411,42 +2904,67 @@ std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::T
   ROS_DEBUG_THROTTLE(1.0, "[MpcTracker]: trajectory subsample offset: %d", trajectory_subsample_offset);
 
   // after this, we should have the correct value of
-  // * trajectory_size
   // * trajectory_sample_offset
   // * trajectory_subsample_offset
 
-  /* copy the trajectory to a local variable //{ */
+  /* copy the trajectory to a new snapshot //{ */
 
   // copy only the part from the first valid index
 
-  MatrixXd des_x_whole_trajectory       = VectorXd::Zero(trajectory_size + _mpc_horizon_len_, 1);
-  MatrixXd des_y_whole_trajectory       = VectorXd::Zero(trajectory_size + _mpc_horizon_len_, 1);
-  MatrixXd des_z_whole_trajectory       = VectorXd::Zero(trajectory_size + _mpc_horizon_len_, 1);
-  MatrixXd des_heading_whole_trajectory = VectorXd::Zero(trajectory_size + _mpc_horizon_len_, 1);
+  // when the heading is not tracked, the current one is held
+  const double current_heading = mpc_x_.load().heading(0, 0);
 
-  for (int i = 0; i < trajectory_size; i++) {
+  auto whole_trajectory = std::make_shared<TrajectorySnapshot_t>();
 
-    des_x_whole_trajectory(i)       = msg.points[trajectory_sample_offset + i].position.x;
-    des_y_whole_trajectory(i)       = msg.points[trajectory_sample_offset + i].position.y;
-    des_z_whole_trajectory(i)       = msg.points[trajectory_sample_offset + i].position.z;
-    des_heading_whole_trajectory(i) = msg.points[trajectory_sample_offset + i].heading;
-  }
+  whole_trajectory->append(msg.points, trajectory_sample_offset, msg.use_heading ? nullptr : &current_heading);
 
   //}
 
+  whole_trajectory->dt   = trajectory_dt;
+  whole_trajectory->loop = msg.loop;
+
+  auto [success, message] = activateTrajectory(whole_trajectory, msg.fly_now, msg.use_heading, trajectory_subsample_offset * _dt1_);
+
+  if (!success) {
+    return std::tuple(false, message, false);
+  }
+
+  publishTrajectoryDebug(*whole_trajectory, msg.header.frame_id);
+
+  return std::tuple(true, "trajectory loaded", false);
+}
+
+//}
+
+/* //{ activateTrajectory() */
+
+// checks the looping, prepares the resampling and replaces the loaded trajectory with the new snapshot
+std::tuple<bool, std::string> MpcTracker::activateTrajectory(const std::shared_ptr<TrajectorySnapshot_t>& whole_trajectory, const bool fly_now,
+                                                             const bool use_heading, const double time_offset) {
+
+  std::stringstream ss;
+
+  const int    trajectory_size = whole_trajectory->size;
+  const double trajectory_dt   = whole_trajectory->dt;
+
   /* set looping //{ */
 
   bool loop = false;
 
-  if (msg.loop) {
+  if (whole_trajectory->loop) {
+
+    int cursor = 0;
 
-    double first_x = des_x_whole_trajectory(0);
-    double first_y = des_y_whole_trajectory(0);
-    double first_z = des_z_whole_trajectory(0);
+    const Eigen::Vector4d first = whole_trajectory->point(0, cursor);
+    const Eigen::Vector4d last  = whole_trajectory->point(trajectory_size - 1, cursor);
 
-    double last_x = des_x_whole_trajectory(trajectory_size - 1);
-    double last_y = des_y_whole_trajectory(trajectory_size - 1);
-    double last_z = des_z_whole_trajectory(trajectory_size - 1);
+    double first_x = first(0);
+    double first_y = first(1);
+    double first_z = first(2);
+
+    double last_x = last(0);
+    double last_y = last(1);
+    double last_z = last(2);
 
     // check whether the trajectory is loopable
     // TODO should check heading aswell
@@ -2459,7 +2977,7 @@ std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::T
 
       ss << "can not loop trajectory, the first and last points are too far apart";
       ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
-      return std::tuple(false, ss.str(), false);
+      return std::tuple(false, ss.str());
     }
 
   } else {
@@ -2472,207 +2990,276 @@ std::tuple<bool, std::string, bool> MpcTracker::loadTrajectory(const mrs_msgs::T
   // by this time, the values of these should be set:
   // * loop
 
-  /* add tail (the last point repeated to fill the prediction horizon) //{ */
+  // past the end, the last point is held (the resampling clamps the indices)
 
-  if (!loop) {
+  whole_trajectory->loop = loop;
 
-    // extend it so it has smooth ending
-    for (int i = 0; i < _mpc_horizon_len_; i++) {
+  // the number of the model steps since the last point runs up to dt / dt1, one more stencil covers the rounding
+  const int n_stencils = int(std::ceil(trajectory_dt / _dt1_)) + 1;
 
-      des_x_whole_trajectory(i + trajectory_size)       = des_x_whole_trajectory(i + trajectory_size - 1);
-      des_y_whole_trajectory(i + trajectory_size)       = des_y_whole_trajectory(i + trajectory_size - 1);
-      des_z_whole_trajectory(i + trajectory_size)       = des_z_whole_trajectory(i + trajectory_size - 1);
-      des_heading_whole_trajectory(i + trajectory_size) = des_heading_whole_trajectory(i + trajectory_size - 1);
-    }
+  auto stencils = std::make_shared<std::vector<HorizonStencil_t>>();
+
+  stencils->reserve(n_stencils);
+
+  for (int i = 0; i < n_stencils; i++) {
+    stencils->push_back(makeHorizonStencil(sample_time_, i * _dt1_, trajectory_dt));
   }
 
-  //}
+  whole_trajectory->stencils = stencils;
+
+  // by this time, the snapshot should be complete and it is not going to be modified anymore
+
+  // everything is prepared before locking, the MPC iteration waits only for the assignments below
+  mpc_horizon_t des_x_trajectory, des_y_trajectory, des_z_trajectory, des_heading_trajectory;
+
+  if (fly_now) {
 
-  // by this time, the values of these should be set correctly:
-  // * trajectory_size
-  // * des_x_whole_trajectory
-  // * des_y_whole_trajectory
-  // * des_z_whole_trajectory
-  // * des_heading_whole_trajectory
+    // interpolate the trajectory points and fill in the desired_trajectory vector
+    int cursor = 0;
+
+    resampleTrajectory(*whole_trajectory, sample_time_, _dt1_, time_offset, cursor, des_x_trajectory, des_y_trajectory, des_z_trajectory,
+                       des_heading_trajectory);
+
+    // the hover timer may have to be waited for, which must not happen under the locks
+    toggleHover(false);
+  }
 
   /* update the global variables //{ */
 
   {
-    std::scoped_lock lock(mutex_des_whole_trajectory_, mutex_des_trajectory_, mutex_trajectory_tracking_states_);
+    std::scoped_lock lock(mutex_des_trajectory_, mutex_trajectory_tracking_states_);
 
-    auto mpc_x_heading = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_heading_);
+    trajectory_tracking_in_progress_ = fly_now;
+    trajectory_track_heading_        = use_heading;
+
+    // publish the snapshot, the MPC timer picks it up during its next iteration
+    std::atomic_store(&whole_trajectory_, std::shared_ptr<const TrajectorySnapshot_t>(whole_trajectory));
+
+    // if we are tracking trajectory, copy the setpoint
+    if (trajectory_tracking_in_progress_) {
+      des_x_trajectory_       = des_x_trajectory;
+      des_y_trajectory_       = des_y_trajectory;
+      des_z_trajectory_       = des_z_trajectory;
+      des_heading_trajectory_ = des_heading_trajectory;
+    }
 
-    trajectory_tracking_in_progress_ = msg.fly_now;
-    trajectory_track_heading_        = msg.use_heading;
+    trajectory_size_             = trajectory_size;
+    trajectory_tracking_start_ = ros::Time::now() - ros::Duration(time_offset);
+    trajectory_tracking_time_  = time_offset;
+    trajectory_set_              = true;
+    trajectory_tracking_loop_    = loop;
+    trajectory_dt_               = trajectory_dt;
+    trajectory_count_++;
+  }
 
-    // allocate the vectors
-    des_x_whole_trajectory_       = std::make_shared<VectorXd>(trajectory_size + _mpc_horizon_len_, 1);
-    des_y_whole_trajectory_       = std::make_shared<VectorXd>(trajectory_size + _mpc_horizon_len_, 1);
-    des_z_whole_trajectory_       = std::make_shared<VectorXd>(trajectory_size + _mpc_horizon_len_, 1);
-    des_heading_whole_trajectory_ = std::make_shared<VectorXd>(trajectory_size + _mpc_horizon_len_, 1);
+  //}
 
-    for (int i = 0; i < trajectory_size + _mpc_horizon_len_; i++) {
+  ROS_INFO_THROTTLE(1, "[MpcTracker]: received trajectory with length %d", trajectory_size);
 
-      (*des_x_whole_trajectory_)(i) = des_x_whole_trajectory(i);
-      (*des_y_whole_trajectory_)(i) = des_y_whole_trajectory(i);
-      (*des_z_whole_trajectory_)(i) = des_z_whole_trajectory(i);
+  publishDiagnostics();
 
-      if (trajectory_track_heading_) {
-        (*des_heading_whole_trajectory_)(i) = des_heading_whole_trajectory(i);
-      } else {
-        (*des_heading_whole_trajectory_).fill(mpc_x_heading(0, 0));
-      }
+  return std::tuple(true, "trajectory loaded");
+}
+
+//}
+
+/* //{ spliceTrajectory() */
+
+// replaces the loaded trajectory from the time of the first new point (header.stamp) onwards, stamp 0 appends the points to its end
+// the points before the splice are not copied, the trajectory keeps being tracked without interruption
+std::tuple<bool, std::string> MpcTracker::spliceTrajectory(const mrs_msgs::TrajectoryReference& msg) {
+
+  std::stringstream ss;
+
+  std::shared_ptr<const TrajectorySnapshot_t> whole_trajectory;
+  mrs_msgs::UavState                          uav_state;
+
+  // the message has to fit the loaded trajectory, which can be replaced (e.g., by switching the odometry) between the attempts
+  auto check = [&](void) {
+    if (!trajectory_set_ || !whole_trajectory) {
+      ss << "can not splice the trajectory, no trajectory is loaded";
+    } else if (whole_trajectory->loop || msg.loop) {
+      ss << "can not splice a looping trajectory";
+    } else if (whole_trajectory->timed) {
+      ss << "can not splice a polynomial or a stamped trajectory";
+    } else if (msg.points.empty()) {
+      ss << "can not splice the trajectory, it has no points";
+    } else if (msg.dt > 1e-4 && fabs(msg.dt - whole_trajectory->dt) > 1e-6) {
+      ss << "can not splice the trajectory, its dt (" << msg.dt << " s) differs from the loaded one (" << whole_trajectory->dt << " s)";
+    } else if (!msg.header.frame_id.empty() && common_handlers_->transformer->resolveFrameName(msg.header.frame_id) != uav_state.header.frame_id) {
+      ss << "can not splice the trajectory, it is not in the current frame '" << uav_state.header.frame_id << "'";
     }
 
-    // if we are tracking trajectory, copy the setpoint
-    if (trajectory_tracking_in_progress_) {
+    return ss.str().empty();
+  };
 
-      toggleHover(false);
+  // the splice is planned under the locks, built without them and installed only when the tracking did not move past it meanwhile
+  for (int attempt = 0; ss.str().empty(); attempt++) {
 
-      /* interpolate the trajectory points and fill in the desired_trajectory vector //{ */
+    if (attempt == 3) {
+      ss << "can not splice the trajectory, the trajectory kept changing while splicing";
+      ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
+      return std::tuple(false, ss.str());
+    }
 
-      for (int i = 0; i < _mpc_horizon_len_; i++) {
+    // the snapshot could have been replaced since the last attempt, it is checked again
+    whole_trajectory = std::atomic_load(&whole_trajectory_);
+    uav_state        = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
 
-        double first_time = _dt1_ + i * _dt2_ + trajectory_subsample_offset * _dt1_;
+    if (!check()) {
+      ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
+      return std::tuple(false, ss.str());
+    }
 
-        int first_idx  = floor(first_time / trajectory_dt);
-        int second_idx = first_idx + 1;
+    const double trajectory_dt = whole_trajectory->dt;
 
-        double interp_coeff = std::fmod(first_time / trajectory_dt, 1.0);
+    int splice_idx = 0;  // where the first new point goes
+    int first_new  = 0;  // the first new point which is used
 
-        if (trajectory_tracking_loop_) {
+    {
+      std::scoped_lock lock(mutex_trajectory_tracking_states_);
 
-          if (second_idx >= trajectory_size) {
-            second_idx -= trajectory_size;
-          }
+      // replaced after it was checked, plan it again
+      if (std::atomic_load(&whole_trajectory_) != whole_trajectory) {
+        continue;
+      }
 
-          if (first_idx >= trajectory_size) {
-            first_idx -= trajectory_size;
-          }
-        } else {
+      splice_idx = whole_trajectory->size;
 
-          if (second_idx >= trajectory_size) {
-            second_idx = trajectory_size - 1;
-          }
+      if (msg.header.stamp != ros::Time(0)) {
 
-          if (first_idx >= trajectory_size) {
-            first_idx = trajectory_size - 1;
-          }
+        if (!trajectory_tracking_in_progress_) {
+          ss << "can not splice the trajectory at a time, it is not being tracked, use stamp 0 to append it";
+          ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
+          return std::tuple(false, ss.str());
         }
 
-        des_x_trajectory_(i, 0) = (1 - interp_coeff) * des_x_whole_trajectory(first_idx) + interp_coeff * des_x_whole_trajectory(second_idx);
-        des_y_trajectory_(i, 0) = (1 - interp_coeff) * des_y_whole_trajectory(first_idx) + interp_coeff * des_y_whole_trajectory(second_idx);
-        des_z_trajectory_(i, 0) = (1 - interp_coeff) * des_z_whole_trajectory(first_idx) + interp_coeff * des_z_whole_trajectory(second_idx);
+        // the stamp is snapped to the closest point
+        const int current_idx = whole_trajectory->index(trajectory_tracking_time_);
 
-        des_heading_trajectory_(i, 0) = sradians::interp(des_heading_whole_trajectory(first_idx), des_heading_whole_trajectory(second_idx), interp_coeff);
+        splice_idx = int(std::round((msg.header.stamp - trajectory_tracking_start_).toSec() / trajectory_dt));
+
+        // the points up to the current one are kept, the older new points are dropped
+        if (splice_idx <= current_idx) {
+          first_new  = current_idx + 1 - splice_idx;
+          splice_idx = current_idx + 1;
+        }
       }
+    }
 
-      //}
+    if (first_new >= int(msg.points.size())) {
+      ss << "can not splice the trajectory, its timestamp is too old";
+    } else if (splice_idx > whole_trajectory->size) {
+      ss << "can not splice the trajectory, there would be a gap of " << splice_idx - whole_trajectory->size << " points";
     }
 
-    trajectory_size_             = trajectory_size;
-    trajectory_tracking_idx_     = 0;
-    trajectory_tracking_sub_idx_ = trajectory_subsample_offset;
-    trajectory_set_              = true;
-    trajectory_tracking_loop_    = loop;
-    trajectory_dt_               = trajectory_dt;
-    trajectory_count_++;
+    if (!ss.str().empty()) {
+      ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
+      return std::tuple(false, ss.str());
+    }
 
-    timer_trajectory_tracking_.setPeriod(ros::Duration(trajectory_dt));
-  }
+    // without the heading, the one of the kept part is held (the spliced trajectory is not timed, the cursor is not used)
+    int cursor = 0;
 
-  //}
+    const double held_heading = splice_idx > 0 ? whole_trajectory->point(splice_idx - 1, cursor)(3) : mpc_x_.load().heading(0);
 
-  if (trajectory_tracking_in_progress_) {
-    timer_trajectory_tracking_.start();
-  }
+    auto spliced_trajectory = std::make_shared<TrajectorySnapshot_t>(*whole_trajectory);
 
-  ROS_INFO_THROTTLE(1, "[MpcTracker]: received trajectory with length %d", trajectory_size);
+    spliced_trajectory->truncate(splice_idx);
+    spliced_trajectory->append(msg.points, first_new, msg.use_heading ? nullptr : &held_heading);
 
-  /* publish the debugging topics of the post-processed trajectory //{ */
+    {
+      std::scoped_lock lock(mutex_des_trajectory_, mutex_trajectory_tracking_states_);
 
-  {
+      // another trajectory was loaded or the tracking already reached the splice, plan it again
+      if (std::atomic_load(&whole_trajectory_) != whole_trajectory ||
+          (msg.header.stamp != ros::Time(0) && whole_trajectory->index(trajectory_tracking_time_) >= splice_idx)) {
+        continue;
+      }
 
-    geometry_msgs::PoseArray debug_trajectory_out;
-    debug_trajectory_out.header.stamp    = ros::Time::now();
-    debug_trajectory_out.header.frame_id = common_handlers_->transformer->resolveFrameName(msg.header.frame_id);
+      std::atomic_store(&whole_trajectory_, std::shared_ptr<const TrajectorySnapshot_t>(spliced_trajectory));
 
-    {
-      std::scoped_lock lock(mutex_des_whole_trajectory_);
+      trajectory_size_ = spliced_trajectory->size;
+      trajectory_count_++;
+    }
 
-      for (int i = 0; i < trajectory_size; i++) {
+    whole_trajectory = spliced_trajectory;
 
-        geometry_msgs::Pose new_pose;
+    ss << "trajectory spliced at point " << splice_idx << ", " << spliced_trajectory->size - splice_idx << " new points";
+  }
 
-        new_pose.position.x = (*des_x_whole_trajectory_)(i);
-        new_pose.position.y = (*des_y_whole_trajectory_)(i);
-        new_pose.position.z = (*des_z_whole_trajectory_)(i);
+  ROS_INFO_THROTTLE(1, "[MpcTracker]: %s", ss.str().c_str());
 
-        new_pose.orientation = mrs_lib::AttitudeConverter(0, 0, (*des_heading_whole_trajectory_)(i));
+  // the debugging topics are rebuilt from the whole trajectory, at a high rate of splices only when someone listens
+  if (pub_debug_processed_trajectory_poses_.getNumSubscribers() > 0 || pub_debug_processed_trajectory_markers_.getNumSubscribers() > 0) {
+    publishTrajectoryDebug(*whole_trajectory, uav_state.header.frame_id);
+  }
 
-        debug_trajectory_out.poses.push_back(new_pose);
-      }
-    }
+  return std::tuple(true, ss.str());
+}
 
-    try {
-      pub_debug_processed_trajectory_poses_.publish(debug_trajectory_out);
-    }
-    catch (...) {
-      ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", pub_debug_processed_trajectory_poses_.getTopic().c_str());
-    }
+//}
 
-    visualization_msgs::MarkerArray msg_out;
+/* //{ loadLibraryTrajectory() */
 
-    visualization_msgs::Marker marker;
+// loads the trajectory <name>.traj from the library, the file is mapped instead of being read, the points are faulted in as they are tracked
+// the trajectory is not started, it is tracked after calling the start trajectory tracking service
+std::tuple<bool, std::string> MpcTracker::loadLibraryTrajectory(const std::string& name) {
 
-    marker.header.stamp     = ros::Time::now();
-    marker.header.frame_id  = common_handlers_->transformer->resolveFrameName(msg.header.frame_id);
-    marker.type             = visualization_msgs::Marker::LINE_LIST;
-    marker.color.a          = 1;
-    marker.scale.x          = 0.05;
-    marker.color.r          = 1;
-    marker.color.g          = 0;
-    marker.color.b          = 0;
-    marker.pose.orientation = mrs_lib::AttitudeConverter(0, 0, 0);
+  std::stringstream ss;
 
-    {
-      std::scoped_lock lock(mutex_des_whole_trajectory_);
+  auto uav_state = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_);
+
+  if (_trajectory_library_path_.empty()) {
+    ss << "can not load the trajectory, the trajectory library path is not set";
+  } else if (name.empty() || name.find('/') != std::string::npos) {
+    ss << "can not load the trajectory, invalid name '" << name << "'";
+  }
 
-      for (int i = 0; i < trajectory_size - 1; i++) {
+  if (!ss.str().empty()) {
+    ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
+    return std::tuple(false, ss.str());
+  }
 
-        geometry_msgs::Point point1;
+  auto        file = std::make_shared<TrajectoryFile>();
+  std::string message;
 
-        point1.x = des_x_whole_trajectory(i);
-        point1.y = des_y_whole_trajectory(i);
-        point1.z = des_z_whole_trajectory(i);
+  if (!file->open(_trajectory_library_path_ + "/" + name + ".traj", message)) {
+    ss << "can not load the trajectory, " << message;
+  } else if (common_handlers_->transformer->resolveFrameName(file->frameId()) != uav_state.header.frame_id) {
+    ss << "can not load the trajectory, its frame '" << file->frameId() << "' is not the current frame '" << uav_state.header.frame_id << "'";
+  }
 
-        marker.points.push_back(point1);
+  if (!ss.str().empty()) {
+    ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
+    return std::tuple(false, ss.str());
+  }
 
-        geometry_msgs::Point point2;
+  auto whole_trajectory = std::make_shared<TrajectorySnapshot_t>();
 
-        point2.x = des_x_whole_trajectory(i + 1);
-        point2.y = des_y_whole_trajectory(i + 1);
-        point2.z = des_z_whole_trajectory(i + 1);
+  if (!whole_trajectory->map(file)) {
+    ss << "can not load the trajectory, its segment durations or stamps are not increasing";
+    ROS_WARN_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
+    return std::tuple(false, ss.str());
+  }
 
-        marker.points.push_back(point2);
-      }
-    }
+  // the file stays mapped while the snapshot uses it
+  auto [success, activate_message] = activateTrajectory(whole_trajectory, false, true, 0);
 
-    msg_out.markers.push_back(marker);
+  if (!success) {
+    return std::tuple(false, activate_message);
+  }
 
-    try {
-      pub_debug_processed_trajectory_markers_.publish(msg_out);
-    }
-    catch (...) {
-      ROS_ERROR("exception caught during publishing topic %s", pub_debug_processed_trajectory_markers_.getTopic().c_str());
-    }
+  // the debugging topics would fault in the whole file
+  if (pub_debug_processed_trajectory_poses_.getNumSubscribers() > 0 || pub_debug_processed_trajectory_markers_.getNumSubscribers() > 0) {
+    publishTrajectoryDebug(*whole_trajectory, uav_state.header.frame_id);
   }
 
-  //}
+  ss << "trajectory '" << name << "' loaded, " << whole_trajectory->size << " points";
 
-  publishDiagnostics();
+  ROS_INFO_THROTTLE(1.0, "[MpcTracker]: %s", ss.str().c_str());
 
-  return std::tuple(true, "trajectory loaded", false);
+  return std::tuple(true, ss.str());
 }
 
 //}
@@ -2699,14 +3286,13 @@ void MpcTracker::setGoal(const double pos_x, const double pos_y, const double po
 
   double desired_heading = sradians::wrap(heading);
 
-  auto mpc_x_heading = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_heading_);
+  auto mpc_x_heading = mpc_x_.load().heading;
 
   if (!use_heading) {
     desired_heading = mpc_x_heading(0, 0);
   }
 
   trajectory_tracking_in_progress_ = false;
-  timer_trajectory_tracking_.stop();
 
   setSinglePointReference(pos_x, pos_y, pos_z, desired_heading);
 
@@ -2719,7 +3305,7 @@ void MpcTracker::setGoal(const double pos_x, const double pos_y, const double po
 
 void MpcTracker::setRelativeGoal(const double pos_x, const double pos_y, const double pos_z, const double heading, const bool use_heading) {
 
-  auto [mpc_x, mpc_x_heading] = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_, mpc_x_heading_);
+  auto [mpc_x, mpc_x_heading] = mpc_x_.load();
 
   double abs_x = mpc_x(0, 0) + pos_x;
   double abs_y = mpc_x(4, 0) + pos_y;
@@ -2732,7 +3318,6 @@ void MpcTracker::setRelativeGoal(const double pos_x, const double pos_y, const d
   }
 
   trajectory_tracking_in_progress_ = false;
-  timer_trajectory_tracking_.stop();
 
   setSinglePointReference(abs_x, abs_y, abs_z, abs_heading);
 
@@ -2785,16 +3370,13 @@ std::tuple<bool, std::string> MpcTracker::startTrajectoryTrackingImpl(void) {
     toggleHover(false);
 
     {
-      std::scoped_lock lock(mutex_des_trajectory_);
+      std::scoped_lock lock(mutex_des_trajectory_, mutex_trajectory_tracking_states_);
 
       trajectory_tracking_in_progress_ = true;
-      trajectory_tracking_idx_         = 0;
-      trajectory_tracking_sub_idx_     = 0;
+      trajectory_tracking_start_       = ros::Time::now();
+      trajectory_tracking_time_        = 0;
     }
 
-    timer_trajectory_tracking_.setPeriod(ros::Duration(trajectory_dt_));
-    timer_trajectory_tracking_.start();
-
     publishDiagnostics();
 
     ss << "trajectory tracking started";
@@ -2823,19 +3405,18 @@ std::tuple<bool, std::string> MpcTracker::resumeTrajectoryTrackingImpl(void) {
 
     toggleHover(false);
 
-    auto trajectory_tracking_idx = mrs_lib::get_mutexed(mutex_trajectory_tracking_states_, trajectory_tracking_idx_);
+    auto trajectory_tracking_time = mrs_lib::get_mutexed(mutex_trajectory_tracking_states_, trajectory_tracking_time_);
 
-    if (trajectory_tracking_idx < (trajectory_size_ - 1)) {
+    if (std::atomic_load(&whole_trajectory_)->index(trajectory_tracking_time) < (trajectory_size_ - 1)) {
 
       {
-        std::scoped_lock lock(mutex_des_trajectory_);
+        std::scoped_lock lock(mutex_des_trajectory_, mutex_trajectory_tracking_states_);
 
+        // continue from the time where the tracking stopped
         trajectory_tracking_in_progress_ = true;
+        trajectory_tracking_start_       = ros::Time::now() - ros::Duration(trajectory_tracking_time_);
       }
 
-      timer_trajectory_tracking_.setPeriod(ros::Duration(trajectory_dt_));
-      timer_trajectory_tracking_.start();
-
       ss << "trajectory tracking resumed";
       ROS_INFO_STREAM_THROTTLE(1.0, "[MpcTracker]: " << ss.str());
 
@@ -2871,7 +3452,6 @@ std::tuple<bool, std::string> MpcTracker::stopTrajectoryTrackingImpl(void) {
   if (trajectory_tracking_in_progress_) {
 
     trajectory_tracking_in_progress_ = false;
-    timer_trajectory_tracking_.stop();
 
     toggleHover(true);
 
@@ -2902,14 +3482,14 @@ std::tuple<bool, std::string> MpcTracker::gotoTrajectoryStartImpl(void) {
     toggleHover(false);
 
     trajectory_tracking_in_progress_ = false;
-    timer_trajectory_tracking_.stop();
 
-    {
-      std::scoped_lock lock(mutex_des_whole_trajectory_);
+    auto whole_trajectory = std::atomic_load(&whole_trajectory_);
 
-      setGoal((*des_x_whole_trajectory_)[0], (*des_y_whole_trajectory_)[0], (*des_z_whole_trajectory_)[0], (*des_heading_whole_trajectory_)[0],
-              trajectory_track_heading_);
-    }
+    int cursor = 0;
+
+    const Eigen::Vector4d start = whole_trajectory->point(0, cursor);
+
+    setGoal(start(0), start(1), start(2), start(3), trajectory_track_heading_);
 
     publishDiagnostics();
 
@@ -2931,11 +3511,91 @@ std::tuple<bool, std::string> MpcTracker::gotoTrajectoryStartImpl(void) {
 
 // | ------------------------- support ------------------------ |
 
-/* //{ publishDiagnostics() */
+/* //{ publishTrajectoryDebug() */
 
-void MpcTracker::publishDiagnostics(void) {
+// publishes the post-processed trajectory
+void MpcTracker::publishTrajectoryDebug(const TrajectorySnapshot_t& trajectory, const std::string& frame_id) {
 
-  auto des_x_trajectory       = mrs_lib::get_mutexed(mutex_des_trajectory_, des_x_trajectory_);
+  geometry_msgs::PoseArray debug_trajectory_out;
+  debug_trajectory_out.header.stamp    = ros::Time::now();
+  debug_trajectory_out.header.frame_id = common_handlers_->transformer->resolveFrameName(frame_id);
+
+  // the points are read in order, a timed trajectory moves its cursor by one point at a time
+  int cursor = 0;
+
+  for (int i = 0; i < trajectory.size; i++) {
+
+    const Eigen::Vector4d point = trajectory.point(i, cursor);
+
+    geometry_msgs::Pose new_pose;
+
+    new_pose.position.x = point(0);
+    new_pose.position.y = point(1);
+    new_pose.position.z = point(2);
+
+    new_pose.orientation = mrs_lib::AttitudeConverter(0, 0, point(3));
+
+    debug_trajectory_out.poses.push_back(new_pose);
+  }
+
+  try {
+    pub_debug_processed_trajectory_poses_.publish(debug_trajectory_out);
+  }
+  catch (...) {
+    ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", pub_debug_processed_trajectory_poses_.getTopic().c_str());
+  }
+
+  visualization_msgs::MarkerArray msg_out;
+
+  visualization_msgs::Marker marker;
+
+  marker.header.stamp     = ros::Time::now();
+  marker.header.frame_id  = common_handlers_->transformer->resolveFrameName(frame_id);
+  marker.type             = visualization_msgs::Marker::LINE_LIST;
+  marker.color.a          = 1;
+  marker.scale.x          = 0.05;
+  marker.color.r          = 1;
+  marker.color.g          = 0;
+  marker.color.b          = 0;
+  marker.pose.orientation = mrs_lib::AttitudeConverter(0, 0, 0);
+
+  // the segments between the consecutive poses, the points are not evaluated again
+  for (int i = 0; i < trajectory.size - 1; i++) {
+
+    geometry_msgs::Point point1;
+
+    point1.x = debug_trajectory_out.poses[i].position.x;
+    point1.y = debug_trajectory_out.poses[i].position.y;
+    point1.z = debug_trajectory_out.poses[i].position.z;
+
+    marker.points.push_back(point1);
+
+    geometry_msgs::Point point2;
+
+    point2.x = debug_trajectory_out.poses[i + 1].position.x;
+    point2.y = debug_trajectory_out.poses[i + 1].position.y;
+    point2.z = debug_trajectory_out.poses[i + 1].position.z;
+
+    marker.points.push_back(point2);
+  }
+
+  msg_out.markers.push_back(marker);
+
+  try {
+    pub_debug_processed_trajectory_markers_.publish(msg_out);
+  }
+  catch (...) {
+    ROS_ERROR("exception caught during publishing topic %s", pub_debug_processed_trajectory_markers_.getTopic().c_str());
+  }
+}
+
+//}
+
+/* //{ publishDiagnostics() */
+
+void MpcTracker::publishDiagnostics(void) {
+
+  auto des_x_trajectory       = mrs_lib::get_mutexed(mutex_des_trajectory_, des_x_trajectory_);
   auto des_y_trajectory       = mrs_lib::get_mutexed(mutex_des_trajectory_, des_y_trajectory_);
   auto des_z_trajectory       = mrs_lib::get_mutexed(mutex_des_trajectory_, des_z_trajectory_);
   auto des_heading_trajectory = mrs_lib::get_mutexed(mutex_des_trajectory_, des_heading_trajectory_);
@@ -2960,24 +3620,18 @@ void MpcTracker::publishDiagnostics(void) {
 
   std::stringstream ss;
 
-  {
-    std::scoped_lock lock(mutex_other_uav_diagnostics_);
-
-    // fill in if other UAVs are sending their trajectories
-    std::map<std::string, mrs_msgs::MpcTrackerDiagnostics>::iterator u = other_uav_diagnostics_.begin();
+  // fill in if other UAVs are sending their trajectories
+  for (const OtherUav_t& other_uav : other_uavs_) {
 
-    while (u != other_uav_diagnostics_.end()) {
+    const OtherUavDiagnostics_t other_diagnostics = other_uav.diagnostics.load();
 
-      if (u->second.collision_avoidance_active) {
+    if (other_diagnostics.collision_avoidance_active) {
 
-        // is the other's trajectory fresh enought?
-        if ((ros::Time::now() - u->second.header.stamp).toSec() < _collision_trajectory_timeout_) {
-          diagnostics.avoidance_active_uavs.push_back(u->first);
-          ss << u->first.c_str() << ", ";
-        }
+      // is the other's trajectory fresh enought?
+      if ((ros::Time::now() - other_diagnostics.stamp).toSec() < _collision_trajectory_timeout_) {
+        diagnostics.avoidance_active_uavs.push_back(other_uav.name);
+        ss << other_uav.name.c_str() << ", ";
       }
-
-      u++;
     }
   }
 
@@ -3026,10 +3680,179 @@ void MpcTracker::publishDiagnostics(void) {
 
 //}
 
+/* //{ publishMpcLoopJitter() */
+
+// [number of iterations, mean, std. dev., min, max wake up latency [us], longest iteration [us], number of overruns] since the last call
+void MpcTracker::publishMpcLoopJitter(void) {
+
+  RealtimeLoopStats_t stats = mpc_loop_->getStats(true);
+
+  std_msgs::Float64MultiArray msg;
+
+  msg.data = {double(stats.n_samples), stats.mean * 1e6, stats.stddev * 1e6, stats.min * 1e6, stats.max * 1e6, stats.max_runtime * 1e6,
+              double(stats.n_overruns)};
+
+  try {
+    pub_mpc_loop_jitter_.publish(msg);
+  }
+  catch (...) {
+    ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", pub_mpc_loop_jitter_.getTopic().c_str());
+  }
+}
+
+//}
+
+/* //{ publishAvoidanceTransformCache() */
+
+// [hits, misses, hit rate [%]] of the cache of the transforms of the avoidance trajectories, since the start
+void MpcTracker::publishAvoidanceTransformCache(void) {
+
+  std_msgs::Float64MultiArray msg;
+
+  {
+    std::scoped_lock lock(mutex_transform_cache_);
+
+    const double n_lookups = double(transform_cache_hits_ + transform_cache_misses_);
+
+    msg.data = {double(transform_cache_hits_), double(transform_cache_misses_), n_lookups > 0 ? 100.0 * transform_cache_hits_ / n_lookups : 0.0};
+  }
+
+  try {
+    pub_avoidance_transform_cache_.publish(msg);
+  }
+  catch (...) {
+    ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", pub_avoidance_transform_cache_.getTopic().c_str());
+  }
+}
+
+//}
+
+/* //{ publishMpcDebug() */
+
+// the solver iterations and status, the reference and the prediction of the last MPC iteration
+void MpcTracker::publishMpcDebug(void) {
+
+  const MpcDebug_t mpc_debug = mpc_debug_.load();
+
+  auto frame_id = mrs_lib::get_mutexed(mutex_uav_state_, uav_state_.header.frame_id);
+
+  {
+    std_msgs::Int32MultiArray msg;
+
+    msg.data = {mpc_debug.iterations.begin(), mpc_debug.iterations.end()};
+
+    try {
+      pub_solver_iterations_.publish(msg);
+    }
+    catch (...) {
+      ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", pub_solver_iterations_.getTopic().c_str());
+    }
+  }
+
+  {
+    std_msgs::Int32MultiArray msg;
+
+    msg.data = {mpc_debug.status.begin(), mpc_debug.status.end()};
+
+    try {
+      pub_solver_status_.publish(msg);
+    }
+    catch (...) {
+      ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", pub_solver_status_.getTopic().c_str());
+    }
+  }
+
+  /* publish mpc reference //{ */
+
+  {
+    geometry_msgs::PoseArray debug_trajectory_out;
+    debug_trajectory_out.header.stamp    = ros::Time::now();
+    debug_trajectory_out.header.frame_id = frame_id;
+
+    for (int i = 0; i < _mpc_horizon_len_; i++) {
+
+      geometry_msgs::Pose new_pose;
+
+      new_pose.position.x = mpc_debug.reference_x(i);
+      new_pose.position.y = mpc_debug.reference_y(i);
+      new_pose.position.z = mpc_debug.reference_z(i);
+
+      new_pose.orientation = mrs_lib::AttitudeConverter(0, 0, mpc_debug.reference_heading(i));
+
+      debug_trajectory_out.poses.push_back(new_pose);
+    }
+
+    try {
+      publisher_mpc_reference_debugging_.publish(debug_trajectory_out);
+    }
+    catch (...) {
+      ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", publisher_mpc_reference_debugging_.getTopic().c_str());
+    }
+  }
+
+  //}
+
+  /* publish predicted future //{ */
+
+  {
+    geometry_msgs::PoseArray debug_trajectory_out;
+    debug_trajectory_out.header.stamp    = ros::Time::now();
+    debug_trajectory_out.header.frame_id = frame_id;
+
+    {
+      std::scoped_lock lock(mutex_predicted_trajectory_);
+
+      for (int i = 0; i < _mpc_horizon_len_; i++) {
+
+        geometry_msgs::Pose newPose;
+
+        newPose.position.x = predicted_trajectory_(i * _mpc_n_states_);
+        newPose.position.y = predicted_trajectory_(i * _mpc_n_states_ + 4);
+        newPose.position.z = predicted_trajectory_(i * _mpc_n_states_ + 8);
+
+        newPose.orientation = mrs_lib::AttitudeConverter(0, 0, predicted_heading_trajectory_(i * _mpc_n_states_));
+
+        debug_trajectory_out.poses.push_back(newPose);
+      }
+    }
+
+    try {
+      publisher_predicted_trajectory_debugging_.publish(debug_trajectory_out);
+    }
+    catch (...) {
+      ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", publisher_predicted_trajectory_debugging_.getTopic().c_str());
+    }
+  }
+
+  //}
+}
+
+//}
+
 // --------------------------------------------------------------
 // |                           timers                           |
 // --------------------------------------------------------------
 
+/* //{ realtimeMPC() */
+
+// an iteration of the dedicated MPC thread, it fakes the timer event for timerMPC()
+void MpcTracker::realtimeMPC(const double lateness) {
+
+  ros::TimerEvent event;
+
+  event.current_real     = ros::Time::now();
+  event.current_expected = event.current_real - ros::Duration(std::max(lateness, 0.0));
+  event.last_real        = mpc_loop_last_real_;
+  event.last_expected    = mpc_loop_last_expected_;
+
+  mpc_loop_last_real_     = event.current_real;
+  mpc_loop_last_expected_ = event.current_expected;
+
+  timerMPC(event);
+}
+
+//}
+
 /* //{ timerDiagnostics() */
 
 // published diagnostics in reguar intervals
@@ -3041,6 +3864,16 @@ void MpcTracker::timerDiagnostics(const ros::TimerEvent& event) {
   mrs_lib::Routine profiler_routine = profiler.createRoutine("timerDiagnostics", _diagnostics_rate_, 0.1, event);
 
   publishDiagnostics();
+
+  if (mpc_loop_) {
+    publishMpcLoopJitter();
+  }
+
+  publishAvoidanceTransformCache();
+
+  if (is_active_ && mpc_computed_) {
+    publishMpcDebug();
+  }
 }
 
 //}
@@ -3075,67 +3908,59 @@ void MpcTracker::timerMPC(const ros::TimerEvent& event) {
   // if we are tracking trajectory, copy the setpoint
   if (trajectory_tracking_in_progress_) {
 
-    MatrixXd des_x_trajectory, des_y_trajectory, des_z_trajectory, des_heading_trajectory;
-    VectorXd des_x_whole_trajectory, des_y_whole_trajectory, des_z_whole_trajectory, des_heading_whole_trajectory;
-    double   trajectory_size, trajectory_dt;
-    {
-      std::scoped_lock lock(mutex_des_trajectory_, mutex_des_whole_trajectory_);
+    // holding the snapshot keeps it alive, no lock is needed while reading from it
+    std::shared_ptr<const TrajectorySnapshot_t> whole_trajectory;
 
-      des_x_trajectory       = des_x_trajectory_;
-      des_y_trajectory       = des_y_trajectory_;
-      des_z_trajectory       = des_z_trajectory_;
-      des_heading_trajectory = des_heading_trajectory_;
+    double trajectory_time;
+    bool   trajectory_finished = false;
 
-      des_x_whole_trajectory       = *des_x_whole_trajectory_;
-      des_y_whole_trajectory       = *des_y_whole_trajectory_;
-      des_z_whole_trajectory       = *des_z_whole_trajectory_;
-      des_heading_whole_trajectory = *des_heading_whole_trajectory_;
+    /* advance the tracking //{ */
 
-      trajectory_size = trajectory_size_;
-      trajectory_dt   = trajectory_dt_;
-    }
+    {
+      std::scoped_lock lock(mutex_trajectory_tracking_states_);
 
-    /* interpolate the trajectory points and fill in the desired_trajectory vector //{ */
+      whole_trajectory = std::atomic_load(&whole_trajectory_);
 
-    double trajectory_tracking_sub_idx = trajectory_tracking_sub_idx_;
-    double trajectory_tracking_idx     = trajectory_tracking_idx_;
+      // the time along the trajectory is rounded to the steps of the model
+      trajectory_time = std::round((ros::Time::now() - trajectory_tracking_start_).toSec() / _dt1_) * _dt1_;
 
-    for (int i = 0; i < _mpc_horizon_len_; i++) {
+      const double trajectory_duration = whole_trajectory->size * whole_trajectory->dt;
 
-      double first_time = _dt1_ + i * _dt2_ + trajectory_tracking_sub_idx * _dt1_;
+      if (trajectory_time >= trajectory_duration) {
 
-      int first_idx  = trajectory_tracking_idx + floor(first_time / trajectory_dt);
-      int second_idx = first_idx + 1;
-
-      double interp_coeff = std::fmod(first_time / trajectory_dt, 1.0);
+        if (trajectory_tracking_loop_) {
 
-      if (trajectory_tracking_loop_) {
+          trajectory_time = std::fmod(trajectory_time, trajectory_duration);
 
-        if (second_idx >= trajectory_size) {
-          second_idx -= trajectory_size;
-        }
+          if (trajectory_time < trajectory_tracking_time_) {
+            ROS_INFO("[MpcTracker]: trajectory looped");
+          }
 
-        if (first_idx >= trajectory_size) {
-          first_idx -= trajectory_size;
-        }
-      } else {
+        } else {
 
-        if (second_idx >= trajectory_size) {
-          second_idx = trajectory_size - 1;
-        }
+          trajectory_time     = (whole_trajectory->size - 1) * whole_trajectory->dt;
+          trajectory_finished = true;
 
-        if (first_idx >= trajectory_size) {
-          first_idx = trajectory_size - 1;
+          trajectory_tracking_in_progress_ = false;
         }
       }
 
-      des_x_trajectory(i, 0) = (1 - interp_coeff) * des_x_whole_trajectory[first_idx] + interp_coeff * des_x_whole_trajectory[second_idx];
-      des_y_trajectory(i, 0) = (1 - interp_coeff) * des_y_whole_trajectory[first_idx] + interp_coeff * des_y_whole_trajectory[second_idx];
-      des_z_trajectory(i, 0) = (1 - interp_coeff) * des_z_whole_trajectory[first_idx] + interp_coeff * des_z_whole_trajectory[second_idx];
+      trajectory_tracking_time_ = trajectory_time;
+    }
 
-      des_heading_trajectory(i, 0) = sradians::interp(des_heading_whole_trajectory[first_idx], des_heading_whole_trajectory[second_idx], interp_coeff);
+    if (trajectory_finished) {
+      ROS_INFO("[MpcTracker]: done tracking trajectory");
     }
 
+    //}
+
+    mpc_horizon_t des_x_trajectory, des_y_trajectory, des_z_trajectory, des_heading_trajectory;
+
+    /* interpolate the trajectory points and fill in the desired_trajectory vector //{ */
+
+    resampleTrajectory(*whole_trajectory, sample_time_, _dt1_, trajectory_time, trajectory_cursor_, des_x_trajectory, des_y_trajectory, des_z_trajectory,
+                       des_heading_trajectory);
+
     {
       std::scoped_lock lock(mutex_des_trajectory_);
 
@@ -3146,13 +3971,6 @@ void MpcTracker::timerMPC(const ros::TimerEvent& event) {
     }
 
     //}
-
-    // increase the trajectory subsampling counter
-    {
-      std::scoped_lock lock(mutex_trajectory_tracking_states_);
-
-      trajectory_tracking_sub_idx_++;
-    }
   }
 
   manageConstraints();
@@ -3175,98 +3993,16 @@ void MpcTracker::timerMPC(const ros::TimerEvent& event) {
 
   mpc_computed_ = true;
 
-  /* publish predicted future //{ */
-
-  {
-    geometry_msgs::PoseArray debug_trajectory_out;
-    debug_trajectory_out.header.stamp    = ros::Time::now();
-    debug_trajectory_out.header.frame_id = uav_state_.header.frame_id;
-
-    {
-      std::scoped_lock lock(mutex_predicted_trajectory_);
-
-      for (int i = 0; i < _mpc_horizon_len_; i++) {
-
-        geometry_msgs::Pose newPose;
-
-        newPose.position.x = predicted_trajectory_(i * _mpc_n_states_);
-        newPose.position.y = predicted_trajectory_(i * _mpc_n_states_ + 4);
-        newPose.position.z = predicted_trajectory_(i * _mpc_n_states_ + 8);
-
-        newPose.orientation = mrs_lib::AttitudeConverter(0, 0, predicted_heading_trajectory_(i * _mpc_n_states_));
-
-        debug_trajectory_out.poses.push_back(newPose);
-      }
-    }
-
-    try {
-      publisher_predicted_trajectory_debugging_.publish(debug_trajectory_out);
-    }
-    catch (...) {
-      ROS_ERROR("[MpcTracker]: exception caught during publishing topic %s", publisher_predicted_trajectory_debugging_.getTopic().c_str());
-    }
-  }
-
-  //}
-
   if (started_with_invalid) {
     mpc_result_invalid_ = false;
-    ROS_INFO("[MpcTracker]: calculated first MPC result after invalidation, x %.2f, y %.2f, hor1x %.2f, hor1y %.2f", mpc_x_(0, 0), mpc_x_(4, 0),
+    auto mpc_x = mpc_x_.load().x;
+    ROS_INFO("[MpcTracker]: calculated first MPC result after invalidation, x %.2f, y %.2f, hor1x %.2f, hor1y %.2f", mpc_x(0, 0), mpc_x(4, 0),
              des_x_trajectory_(0, 0), des_y_trajectory_(0, 0));
   }
 }
 
 //}
 
-/* timerTrajectoryTracking() //{ */
-
-void MpcTracker::timerTrajectoryTracking(const ros::TimerEvent& event) {
-
-  auto trajectory_size = mrs_lib::get_mutexed(mutex_des_trajectory_, trajectory_size_);
-  auto trajectory_dt   = mrs_lib::get_mutexed(mutex_trajectory_tracking_states_, trajectory_dt_);
-
-  mrs_lib::Routine profiler_routine = profiler.createRoutine("timerTrajectoryTracking", int(1.0 / trajectory_dt), 0.01, event);
-
-  {
-    std::scoped_lock lock(mutex_trajectory_tracking_states_);
-
-    // do a step of the main tracking idx
-
-    // reset the subsampling counter
-    trajectory_tracking_sub_idx_ = 0;
-
-    // INCREMENT THE TRACKING IDX
-    trajectory_tracking_idx_++;
-
-    // if the tracking idx hits the end of the trajectory
-    if (trajectory_tracking_idx_ == trajectory_size) {
-
-      if (trajectory_tracking_loop_) {
-
-        // reset the idx
-        trajectory_tracking_idx_ = 0;
-
-        ROS_INFO("[MpcTracker]: trajectory looped");
-
-      } else {
-
-        trajectory_tracking_in_progress_ = false;
-
-        // set the idx to the last idx of the trajectory
-        trajectory_tracking_idx_ = trajectory_size - 1;
-
-        timer_trajectory_tracking_.stop();
-
-        ROS_INFO("[MpcTracker]: done tracking trajectory");
-      }
-    }
-  }
-
-  publishDiagnostics();
-}
-
-//}
-
 /* //{ timerAvoidanceTrajectory() */
 
 void MpcTracker::timerAvoidanceTrajectory(const ros::TimerEvent& event) {
@@ -3302,7 +4038,7 @@ void MpcTracker::timerAvoidanceTrajectory(const ros::TimerEvent& event) {
     avoidance_trajectory.collision_avoidance = collision_avoidance_enabled_;
 
     // transform it from utm_origin to the currently used frame
-    auto res = common_handlers_->transformer->getTransform(uav_state.header.frame_id, "utm_origin", ros::Time::now(), true);
+    auto res = getAvoidanceTransform(uav_state.header.frame_id, "utm_origin");
 
     if (!res) {
 
@@ -3313,40 +4049,24 @@ void MpcTracker::timerAvoidanceTrajectory(const ros::TimerEvent& event) {
 
     } else {
 
-      mrs_lib::TransformStamped tf = res.value();
-
-      for (int i = 0; i < _mpc_horizon_len_; i++) {
-
-        // original point
-        geometry_msgs::PoseStamped original_point;
-
-        original_point.header.stamp    = ros::Time::now();
-        original_point.header.frame_id = uav_state.header.frame_id;
-
-        original_point.pose.position.x = predicted_trajectory(i * _mpc_n_states_);
-        original_point.pose.position.y = predicted_trajectory(i * _mpc_n_states_ + 4);
-        original_point.pose.position.z = predicted_trajectory(i * _mpc_n_states_ + 8);
+      const Eigen::Isometry3d transform = res.value();
 
-        original_point.pose.orientation = mrs_lib::AttitudeConverter(0, 0, 0);
+      // the positions are interleaved with the other states, they are gathered and then transformed at once
+      Eigen::Matrix<double, 3, Eigen::Dynamic, 0, 3, MPC_MAX_HORIZON_LEN> points(3, _mpc_horizon_len_);
 
-        auto res = common_handlers_->transformer->transform(tf, original_point);
-
-        if (res) {
-
-          mrs_msgs::FuturePoint new_point;
-
-          new_point.x = res.value().pose.position.x;
-          new_point.y = res.value().pose.position.y;
-          new_point.z = res.value().pose.position.z;
+      for (int i = 0; i < _mpc_horizon_len_; i++) {
+        points.col(i) << predicted_trajectory(i * _mpc_n_states_), predicted_trajectory(i * _mpc_n_states_ + 4),
+            predicted_trajectory(i * _mpc_n_states_ + 8);
+      }
 
-          avoidance_trajectory.points.push_back(new_point);
+      points = (transform.linear() * points).colwise() + transform.translation();
 
-        } else {
+      avoidance_trajectory.points.resize(_mpc_horizon_len_);
 
-          std::string message = "[MpcTracker]: can not transform a point of a future trajectory";
-          ROS_WARN_STREAM_ONCE(message);
-          ROS_DEBUG_STREAM_THROTTLE(1.0, message);
-        }
+      for (int i = 0; i < _mpc_horizon_len_; i++) {
+        avoidance_trajectory.points[i].x = points(0, i);
+        avoidance_trajectory.points[i].y = points(1, i);
+        avoidance_trajectory.points[i].z = points(2, i);
       }
     }
 
@@ -3366,7 +4086,7 @@ void MpcTracker::timerAvoidanceTrajectory(const ros::TimerEvent& event) {
 void MpcTracker::timerHover(const ros::TimerEvent& event) {
 
   mrs_lib::ScopeUnset unset_running(mpc_timer_running_);
-  auto                mpc_x = mrs_lib::get_mutexed(mutex_mpc_x_, mpc_x_);
+  auto                mpc_x = mpc_x_.load().x;
 
   mrs_lib::Routine profiler_routine = profiler.createRoutine("timerHover", 10, 0.01, event);
 
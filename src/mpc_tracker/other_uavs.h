@@ -0,0 +1,111 @@
+#ifndef MPC_TRACKER_OTHER_UAVS_H
+#define MPC_TRACKER_OTHER_UAVS_H
+
+#include <eigen3/Eigen/Eigen>
+
+#include <ros/time.h>
+
+#include <string>
+#include <cstdint>
+#include <cmath>
+
+#include "horizon.h"
+#include "seq_lock.h"
+
+namespace mrs_uav_trackers
+{
+
+namespace mpc_tracker
+{
+
+/* struct OtherUav_t //{ */
+
+// what the collision check needs to skip another UAV, the bounding box lets it skip the UAVs which are far away without copying the points
+struct OtherUavSummary_t {
+  ros::Time                    stamp;  // of receiving the trajectory, zero until the first one arrives
+  PlainMatrix<Eigen::Vector3d> box_min;  // of the positions
+  PlainMatrix<Eigen::Vector3d> box_max;
+
+  Eigen::AlignedBox3d box(void) const {
+    return Eigen::AlignedBox3d(box_min.map(), box_max.map());
+  }
+
+  void setBox(const Eigen::AlignedBox3d& box) {
+    box_min = box.min();
+    box_max = box.max();
+  }
+};
+
+// the predicted trajectory of another UAV, transformed to our frame
+struct OtherUavTrajectory_t {
+  OtherUavSummary_t                                         summary;
+  PlainMatrix<Eigen::Array<double, MPC_MAX_HORIZON_LEN, 3>> positions;  // columns x, y, z, only the first n_points are valid
+  std::int32_t                                              n_points;   // as many as the collision check tests
+  std::int32_t                                              priority;
+  std::int32_t                                              collision_avoidance;
+};
+
+// the diagnostics of another UAV, as much as we use
+struct OtherUavDiagnostics_t {
+  ros::Time    stamp;  // of receiving, zero until the first one arrives
+  std::int64_t collision_avoidance_active;
+};
+
+// a slot in the table of the other UAVs, it is indexed by the position of the UAV in network/robot_names
+// the slot is written in place by the subscriber of the UAV (the handlers are thread safe, so there is a single writer) and the readers
+// take snapshots without locking
+struct OtherUav_t {
+  std::string                    name;
+  SeqLock<OtherUavSummary_t>     summary;  // stored after the trajectory, so it never announces a trajectory which was not stored yet
+  SeqLock<OtherUavTrajectory_t>  trajectory;
+  SeqLock<OtherUavDiagnostics_t> diagnostics;
+};
+
+//}
+
+/* inflatedBox() //{ */
+
+// the box of our positions grown by the inflated distances (1 m more than radius horizontally and height vertically), another UAV whose
+// box does not touch it can not collide at any sample
+inline Eigen::AlignedBox3d inflatedBox(const mpc_positions_t& positions, const double radius, const double height) {
+
+  Eigen::AlignedBox3d box(positions.colwise().minCoeff().transpose().matrix(), positions.colwise().maxCoeff().transpose().matrix());
+
+  const Eigen::Vector3d inflation(radius + 1.0, radius + 1.0, height + 1.0);
+
+  box.min() -= inflation;
+  box.max() += inflation;
+
+  return box;
+}
+
+//}
+
+/* collisionMargins() //{ */
+
+// the margins of our positions to the other UAV over the first other.n_points samples, a sample collides when its margin is negative,
+// i.e., when it is within both the radius horizontally and the height vertically, the inflated margins are for the distances grown by 1 m
+// the margins are kept as doubles, Eigen does not vectorize the boolean arrays, the max of the doubles it does
+inline void collisionMargins(const mpc_positions_t& positions, const OtherUavTrajectory_t& other, const double radius, const double height,
+                             mpc_horizon_array_t& collision, mpc_horizon_array_t& collision_inflated) {
+
+  const int  n_points        = other.n_points;
+  const auto other_positions = other.positions.map().topRows(n_points);
+
+  // all the samples at once, the columns are contiguous, so the expressions vectorize
+  // the distances are compared squared, the sqrt is not needed
+  const mpc_horizon_array_t dist_sq = (positions.col(0).head(n_points) - other_positions.col(0)).square() +
+                                      (positions.col(1).head(n_points) - other_positions.col(1)).square();
+  const mpc_horizon_array_t dist_z  = (positions.col(2).head(n_points) - other_positions.col(2)).abs();
+
+  collision          = (dist_sq - radius * radius).max(dist_z - height);
+  collision_inflated = (dist_sq - std::pow(radius + 1.0, 2)).max(dist_z - (height + 1.0));
+}
+
+//}
+
+}  // namespace mpc_tracker
+
+}  // namespace mrs_uav_trackers
+
+#endif
@@ -0,0 +1,388 @@
+#ifndef MPC_TRACKER_REALTIME_LOOP_H
+#define MPC_TRACKER_REALTIME_LOOP_H
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <string>
+
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+namespace mrs_uav_trackers
+{
+
+namespace mpc_tracker
+{
+
+/* struct RealtimeLoopStats_t //{ */
+
+// wake up latencies of the loop [s], since the last reset of the statistics
+struct RealtimeLoopStats_t
+{
+  int    n_samples   = 0;
+  int    n_overruns  = 0;  // iterations which did not finish before the next deadline
+  double mean        = 0;
+  double stddev      = 0;
+  double min         = 0;
+  double max         = 0;
+  double max_runtime = 0;  // the longest iteration [s]
+};
+
+//}
+
+/* class RealtimeLoop //{ */
+
+/**
+ * @brief Runs a callback periodically on its own thread.
+ *
+ * The thread sleeps until absolute deadlines on the monotonic clock, so the period does not drift with the duration of the callback.
+ * The thread can be given a SCHED_FIFO priority and pinned to a CPU, both are applied by the thread itself before its first deadline.
+ * When an iteration overruns the period, the missed deadlines are skipped and the loop continues on the original grid.
+ */
+class RealtimeLoop {
+
+public:
+  // the thread is given the name (at most 15 characters), so it can be told apart, e.g., in top
+  RealtimeLoop(const std::string& name, const double period, std::function<void(const double lateness)> callback);
+  ~RealtimeLoop();
+
+  RealtimeLoop(const RealtimeLoop&) = delete;
+  RealtimeLoop& operator=(const RealtimeLoop&) = delete;
+
+  // have to be called before start()
+  bool setPriority(const int priority, std::string& message);
+  bool setAffinity(const int cpu, std::string& message);
+
+  bool start(std::string& message);
+  void stop(void);
+
+  void pause(void);
+  void resume(void);
+
+  RealtimeLoopStats_t getStats(const bool reset);
+
+private:
+  void loop(std::promise<std::string> scheduling);
+
+  // applies the priority and the affinity to the calling thread, returns the errors
+  std::string applyScheduling(void);
+
+  static void addNanoseconds(timespec& time, const long nsec);
+  static long diffNanoseconds(const timespec& a, const timespec& b);
+
+  std::thread thread_;
+  std::string name_;
+
+  long                                      period_ns_;
+  std::function<void(const double lateness)> callback_;
+
+  int priority_ = 0;   // 0 = the default scheduling
+  int cpu_      = -1;  // -1 = not pinned
+
+  std::atomic<bool> running_ = false;
+  std::atomic<bool> paused_  = false;
+
+  std::mutex mutex_stats_;
+  int        n_samples_   = 0;
+  int        n_overruns_  = 0;
+  double     sum_         = 0;
+  double     sum_sq_      = 0;
+  double     min_         = 0;
+  double     max_         = 0;
+  double     max_runtime_ = 0;
+};
+
+//}
+
+/* RealtimeLoop() //{ */
+
+inline RealtimeLoop::RealtimeLoop(const std::string& name, const double period, std::function<void(const double lateness)> callback) {
+
+  name_      = name.substr(0, 15);
+  period_ns_ = long(std::round(period * 1e9));
+  callback_  = callback;
+}
+
+//}
+
+/* ~RealtimeLoop() //{ */
+
+inline RealtimeLoop::~RealtimeLoop() {
+
+  stop();
+}
+
+//}
+
+/* setPriority() //{ */
+
+inline bool RealtimeLoop::setPriority(const int priority, std::string& message) {
+
+  const int min_priority = sched_get_priority_min(SCHED_FIFO);
+  const int max_priority = sched_get_priority_max(SCHED_FIFO);
+
+  if (priority != 0 && (priority < min_priority || priority > max_priority)) {
+    message = "the SCHED_FIFO priority has to be between " + std::to_string(min_priority) + " and " + std::to_string(max_priority);
+    return false;
+  }
+
+  priority_ = priority;
+
+  return true;
+}
+
+//}
+
+/* setAffinity() //{ */
+
+inline bool RealtimeLoop::setAffinity(const int cpu, std::string& message) {
+
+  const int n_cpus = int(std::thread::hardware_concurrency());
+
+  if (cpu >= n_cpus || cpu >= CPU_SETSIZE) {
+    message = "the CPU " + std::to_string(cpu) + " does not exist, there are " + std::to_string(n_cpus) + " CPUs";
+    return false;
+  }
+
+  cpu_ = cpu;
+
+  return true;
+}
+
+//}
+
+/* start() //{ */
+
+// returns false when the scheduling could not be applied, the loop runs anyway
+inline bool RealtimeLoop::start(std::string& message) {
+
+  if (running_) {
+    return true;
+  }
+
+  running_ = true;
+
+  std::promise<std::string> scheduling;
+  std::future<std::string>  scheduling_errors = scheduling.get_future();
+
+  thread_ = std::thread(&RealtimeLoop::loop, this, std::move(scheduling));
+
+  // the thread reports before it takes the first deadline
+  const std::string errors = scheduling_errors.get();
+
+  message += errors;
+
+  return errors.empty();
+}
+
+//}
+
+/* stop() //{ */
+
+inline void RealtimeLoop::stop(void) {
+
+  running_ = false;
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+//}
+
+/* pause() //{ */
+
+// the iterations are skipped until resume(), an iteration in progress is finished
+inline void RealtimeLoop::pause(void) {
+
+  paused_ = true;
+}
+
+//}
+
+/* resume() //{ */
+
+inline void RealtimeLoop::resume(void) {
+
+  paused_ = false;
+}
+
+//}
+
+/* getStats() //{ */
+
+inline RealtimeLoopStats_t RealtimeLoop::getStats(const bool reset) {
+
+  std::scoped_lock lock(mutex_stats_);
+
+  RealtimeLoopStats_t stats;
+
+  stats.n_samples   = n_samples_;
+  stats.n_overruns  = n_overruns_;
+  stats.min         = min_;
+  stats.max         = max_;
+  stats.max_runtime = max_runtime_;
+
+  if (n_samples_ > 0) {
+    stats.mean   = sum_ / n_samples_;
+    stats.stddev = std::sqrt(std::max(0.0, sum_sq_ / n_samples_ - stats.mean * stats.mean));
+  }
+
+  if (reset) {
+    n_samples_   = 0;
+    n_overruns_  = 0;
+    sum_         = 0;
+    sum_sq_      = 0;
+    min_         = 0;
+    max_         = 0;
+    max_runtime_ = 0;
+  }
+
+  return stats;
+}
+
+//}
+
+/* applyScheduling() //{ */
+
+inline std::string RealtimeLoop::applyScheduling(void) {
+
+  std::string errors;
+
+  if (priority_ > 0) {
+
+    sched_param param;
+    param.sched_priority = priority_;
+
+    const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+    if (ret != 0) {
+      errors += std::string("could not set the SCHED_FIFO priority: ") + std::strerror(ret) + "; ";
+    }
+  }
+
+  if (cpu_ >= 0) {
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu_, &cpu_set);
+
+    const int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+
+    if (ret != 0) {
+      errors += std::string("could not set the CPU affinity: ") + std::strerror(ret) + "; ";
+    }
+  }
+
+  return errors;
+}
+
+//}
+
+/* loop() //{ */
+
+inline void RealtimeLoop::loop(std::promise<std::string> scheduling) {
+
+  pthread_setname_np(pthread_self(), name_.c_str());
+
+  // the first deadline is taken only after the thread runs with its final scheduling and on its CPU
+  scheduling.set_value(applyScheduling());
+
+  timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+  while (running_) {
+
+    addNanoseconds(deadline, period_ns_);
+
+    // EINTR just means that the sleep has to continue
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {
+    }
+
+    if (!running_) {
+      break;
+    }
+
+    timespec wake_up;
+    clock_gettime(CLOCK_MONOTONIC, &wake_up);
+
+    const double lateness = diffNanoseconds(wake_up, deadline) * 1e-9;
+
+    if (!paused_) {
+      callback_(lateness);
+    }
+
+    timespec finished;
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+
+    const long runtime_ns = diffNanoseconds(finished, wake_up);
+
+    // skip the deadlines which have already passed
+    int        overruns    = 0;
+    const long overtime_ns = diffNanoseconds(finished, deadline);
+
+    if (overtime_ns >= period_ns_) {
+      overruns = int(overtime_ns / period_ns_);
+      addNanoseconds(deadline, overruns * period_ns_);
+    }
+
+    {
+      std::scoped_lock lock(mutex_stats_);
+
+      if (n_samples_ == 0) {
+        min_ = lateness;
+        max_ = lateness;
+      } else {
+        min_ = std::min(min_, lateness);
+        max_ = std::max(max_, lateness);
+      }
+
+      n_samples_++;
+      n_overruns_ += overruns;
+      sum_ += lateness;
+      sum_sq_ += lateness * lateness;
+      max_runtime_ = std::max(max_runtime_, runtime_ns * 1e-9);
+    }
+  }
+}
+
+//}
+
+/* addNanoseconds() //{ */
+
+inline void RealtimeLoop::addNanoseconds(timespec& time, const long nsec) {
+
+  time.tv_sec += nsec / 1000000000L;
+  time.tv_nsec += nsec % 1000000000L;
+
+  if (time.tv_nsec >= 1000000000L) {
+    time.tv_sec++;
+    time.tv_nsec -= 1000000000L;
+  }
+}
+
+//}
+
+/* diffNanoseconds() //{ */
+
+// a - b
+inline long RealtimeLoop::diffNanoseconds(const timespec& a, const timespec& b) {
+
+  return (a.tv_sec - b.tv_sec) * 1000000000L + (a.tv_nsec - b.tv_nsec);
+}
+
+//}
+
+}  // namespace mpc_tracker
+
+}  // namespace mrs_uav_trackers
+
+#endif
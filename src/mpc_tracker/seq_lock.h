@@ -0,0 +1,227 @@
+#ifndef MPC_TRACKER_SEQ_LOCK_H
+#define MPC_TRACKER_SEQ_LOCK_H
+
+#include <eigen3/Eigen/Core>
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mrs_uav_trackers
+{
+
+namespace mpc_tracker
+{
+
+/* class PlainMatrix //{ */
+
+/**
+ * @brief An Eigen matrix held as a plain array of its coefficients, so it can be passed through a SeqLock.
+ *
+ * It is assigned from and converted to the matrix (also the ones with a dynamic size bounded by MaxRows and MaxCols), the coefficients can
+ * be read in place by the operator() or viewed by map().
+ */
+template <typename MatrixT>
+struct PlainMatrix
+{
+  typedef typename MatrixT::Scalar Scalar;
+
+  static constexpr int max_rows = MatrixT::MaxRowsAtCompileTime;
+  static constexpr int max_cols = MatrixT::MaxColsAtCompileTime;
+
+  static_assert(max_rows != Eigen::Dynamic && max_cols != Eigen::Dynamic, "the size has to be bounded");
+
+  std::int64_t rows = MatrixT::RowsAtCompileTime == Eigen::Dynamic ? 0 : MatrixT::RowsAtCompileTime;
+  std::int64_t cols = MatrixT::ColsAtCompileTime == Eigen::Dynamic ? 0 : MatrixT::ColsAtCompileTime;
+  Scalar       data[max_rows * max_cols];
+
+  PlainMatrix() = default;
+
+  template <typename Derived>
+  PlainMatrix(const Eigen::DenseBase<Derived>& matrix) {
+    *this = matrix;
+  }
+
+  template <typename Derived>
+  PlainMatrix& operator=(const Eigen::DenseBase<Derived>& matrix) {
+    rows  = matrix.rows();
+    cols  = matrix.cols();
+    map() = matrix;
+    return *this;
+  }
+
+  // the size of a fixed size matrix is not read, so also the zeroed value of a SeqLock which was not stored yet can be viewed
+  Eigen::Map<MatrixT> map(void) {
+    if constexpr (MatrixT::SizeAtCompileTime != Eigen::Dynamic) {
+      return Eigen::Map<MatrixT>(data);
+    } else {
+      return Eigen::Map<MatrixT>(data, rows, cols);
+    }
+  }
+
+  Eigen::Map<const MatrixT> map(void) const {
+    if constexpr (MatrixT::SizeAtCompileTime != Eigen::Dynamic) {
+      return Eigen::Map<const MatrixT>(data);
+    } else {
+      return Eigen::Map<const MatrixT>(data, rows, cols);
+    }
+  }
+
+  operator MatrixT(void) const {
+    return map();
+  }
+
+  Scalar operator()(const Eigen::Index i) const {
+    return map()(i);
+  }
+
+  Scalar operator()(const Eigen::Index row, const Eigen::Index col) const {
+    return map()(row, col);
+  }
+
+  Scalar& operator()(const Eigen::Index i) {
+    return map()(i);
+  }
+
+  Scalar& operator()(const Eigen::Index row, const Eigen::Index col) {
+    return map()(row, col);
+  }
+};
+
+//}
+
+/* class SeqLock //{ */
+
+/**
+ * @brief A double buffered sequence lock for passing a small value between threads without locking.
+ *
+ * The writer fills the buffer which is not published and then publishes it, the readers copy the published buffer and retry when it
+ * was overwritten meanwhile. A reader therefore never waits for a writer which was preempted in the middle of a write, it retries only
+ * when the writer finished two writes during its read.
+ *
+ * There may be only one writer at a time (the writers have to be serialized by the caller), the number of readers is not limited.
+ * The value is copied bitwise, so it has to be trivially copyable. The Eigen matrices are not, they are held as PlainMatrix.
+ */
+template <typename T>
+class SeqLock {
+
+  static_assert(std::is_trivially_copyable_v<T>, "the value is copied bitwise");
+  static_assert(sizeof(T) % sizeof(std::uint64_t) == 0, "the value is copied in 64 bit words");
+
+public:
+  SeqLock();
+  explicit SeqLock(const T& value);
+
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+
+  void store(const T& value);
+  T    load(void) const;
+
+private:
+  static constexpr int n_words_ = sizeof(T) / sizeof(std::uint64_t);
+
+  struct Buffer_t
+  {
+    std::atomic<unsigned long>                      seq = 0;  // odd while being written
+    std::array<std::atomic<std::uint64_t>, n_words_> data;
+  };
+
+  std::array<Buffer_t, 2>    buffers_;
+  std::atomic<unsigned long> version_ = 0;  // the published buffer is buffers_[version_ % 2]
+};
+
+//}
+
+/* SeqLock() //{ */
+
+template <typename T>
+SeqLock<T>::SeqLock() {
+
+  for (auto& buffer : buffers_) {
+    for (auto& word : buffer.data) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T>
+SeqLock<T>::SeqLock(const T& value) : SeqLock() {
+
+  store(value);
+}
+
+//}
+
+/* store() //{ */
+
+template <typename T>
+void SeqLock<T>::store(const T& value) {
+
+  std::uint64_t words[n_words_];
+  std::memcpy(words, &value, sizeof(T));
+
+  const unsigned long version = version_.load(std::memory_order_relaxed) + 1;
+
+  Buffer_t& buffer = buffers_[version % 2];
+
+  const unsigned long seq = buffer.seq.load(std::memory_order_relaxed);
+
+  buffer.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (int i = 0; i < n_words_; i++) {
+    buffer.data[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  buffer.seq.store(seq + 2, std::memory_order_release);
+
+  version_.store(version, std::memory_order_release);
+}
+
+//}
+
+/* load() //{ */
+
+template <typename T>
+T SeqLock<T>::load(void) const {
+
+  std::uint64_t words[n_words_];
+
+  while (true) {
+
+    const Buffer_t& buffer = buffers_[version_.load(std::memory_order_acquire) % 2];
+
+    const unsigned long seq_before = buffer.seq.load(std::memory_order_acquire);
+
+    // the writer has already moved on to this buffer
+    if (seq_before % 2 != 0) {
+      continue;
+    }
+
+    for (int i = 0; i < n_words_; i++) {
+      words[i] = buffer.data[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (buffer.seq.load(std::memory_order_relaxed) == seq_before) {
+      break;
+    }
+  }
+
+  T value;
+  std::memcpy(&value, words, sizeof(T));
+
+  return value;
+}
+
+//}
+
+}  // namespace mpc_tracker
+
+}  // namespace mrs_uav_trackers
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef MPC_TRACKER_TRAJECTORY_FILE_H
+#define MPC_TRACKER_TRAJECTORY_FILE_H
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace mrs_uav_trackers
+{
+
+namespace mpc_tracker
+{
+
+/* struct TrajectoryFileHeader_t //{ */
+
+/**
+ * @brief The header of a trajectory library file.
+ *
+ * The header is followed by n_records points of 4 doubles [x, y, z, heading], the points are sampled with the fixed dt and they are in the
+ * frame frame_id. With TRAJECTORY_FILE_POLYNOMIAL, the records are polynomial segments instead, every segment is its duration [s] followed
+ * by TRAJECTORY_FILE_N_COEFFS coefficients of x, y, z and heading each, in the increasing powers of the time since the start of the
+ * segment. With TRAJECTORY_FILE_STAMPED, the points are followed by n_records increasing timestamps [s] of the points, the spacing of the
+ * points is then arbitrary. The polynomial and the stamped trajectories are tracked as if they were sampled with the dt. All the numbers
+ * are in the native byte order of the machine (little endian).
+ */
+struct TrajectoryFileHeader_t
+{
+  char          magic[8];       // "MRSTRAJ" followed by a zero
+  std::uint32_t version;        // 1
+  std::uint32_t flags;          // TRAJECTORY_FILE_LOOP | (TRAJECTORY_FILE_POLYNOMIAL or TRAJECTORY_FILE_STAMPED)
+  std::uint64_t n_records;      // points or segments
+  double        dt;             // [s]
+  char          frame_id[64];   // zero terminated
+};
+
+static_assert(sizeof(TrajectoryFileHeader_t) == 96, "the header is a part of the file format");
+static_assert(sizeof(TrajectoryFileHeader_t) % sizeof(double) == 0, "the records have to be aligned");
+
+static const char          TRAJECTORY_FILE_MAGIC[8]   = "MRSTRAJ";
+static const std::uint32_t TRAJECTORY_FILE_VERSION    = 1;
+static const std::uint32_t TRAJECTORY_FILE_LOOP       = 1 << 0;
+static const std::uint32_t TRAJECTORY_FILE_POLYNOMIAL = 1 << 1;
+static const std::uint32_t TRAJECTORY_FILE_STAMPED    = 1 << 2;
+
+static const int TRAJECTORY_FILE_N_COEFFS = 8;  // polynomials up to the 7th order
+
+//}
+
+/* class TrajectoryFile //{ */
+
+/**
+ * @brief A read-only memory mapping of a trajectory library file.
+ *
+ * Opening the file checks only the header and the size of the file, the records are not read, so the pages are faulted in only when the
+ * tracker reaches them and the kernel may drop them again afterwards. The file stays mapped until the object is destroyed.
+ */
+class TrajectoryFile {
+
+public:
+  TrajectoryFile(void) = default;
+  ~TrajectoryFile();
+
+  TrajectoryFile(const TrajectoryFile&) = delete;
+  TrajectoryFile& operator=(const TrajectoryFile&) = delete;
+
+  bool open(const std::string& path, std::string& message);
+
+  int         size(void) const;  // number of records
+  double      dt(void) const;
+  bool        loop(void) const;
+  bool        polynomial(void) const;
+  bool        stamped(void) const;
+  std::string frameId(void) const;
+
+  // number of doubles per record
+  int recordLen(void) const;
+
+  // the records, the points or the segments
+  const double* records(void) const;
+
+  // the timestamps of the points of a stamped file
+  const double* stamps(void) const;
+
+private:
+  void*       data_   = nullptr;
+  std::size_t length_ = 0;
+
+  const TrajectoryFileHeader_t* header_ = nullptr;
+};
+
+//}
+
+/* ~TrajectoryFile() //{ */
+
+inline TrajectoryFile::~TrajectoryFile() {
+
+  if (data_ != nullptr) {
+    munmap(data_, length_);
+  }
+}
+
+//}
+
+/* open() //{ */
+
+inline bool TrajectoryFile::open(const std::string& path, std::string& message) {
+
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0) {
+    message = "could not open '" + path + "': " + std::strerror(errno);
+    return false;
+  }
+
+  struct stat file_stat;
+
+  if (fstat(fd, &file_stat) != 0) {
+    message = "could not stat '" + path + "': " + std::strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  if (std::size_t(file_stat.st_size) < sizeof(TrajectoryFileHeader_t)) {
+    message = "'" + path + "' is too short for a trajectory file";
+    close(fd);
+    return false;
+  }
+
+  length_ = file_stat.st_size;
+
+  void* data = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // the mapping keeps the file open
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    message = "could not map '" + path + "': " + std::strerror(errno);
+    return false;
+  }
+
+  data_   = data;
+  header_ = static_cast<const TrajectoryFileHeader_t*>(data_);
+
+  // the records are read from the front to the back, the kernel reads ahead and frees the pages behind
+  madvise(data_, length_, MADV_SEQUENTIAL);
+
+  // the process memory may be locked on fault (mpc_loop/lock_memory), the library would then stay resident as it is being flown
+  munlock(data_, length_);
+
+  if (std::memcmp(header_->magic, TRAJECTORY_FILE_MAGIC, sizeof(TRAJECTORY_FILE_MAGIC)) != 0) {
+    message = "'" + path + "' is not a trajectory file";
+    return false;
+  }
+
+  if (header_->version != TRAJECTORY_FILE_VERSION) {
+    message = "'" + path + "' has an unsupported version " + std::to_string(header_->version);
+    return false;
+  }
+
+  if (polynomial() && stamped()) {
+    message = "'" + path + "' can not be both polynomial and stamped";
+    return false;
+  }
+
+  const int n_doubles = recordLen() + (stamped() ? 1 : 0);
+
+  if (header_->n_records == 0 || header_->n_records > std::uint64_t(INT32_MAX / n_doubles)) {
+    message = "'" + path + "' has an invalid number of records " + std::to_string(header_->n_records);
+    return false;
+  }
+
+  if (length_ != sizeof(TrajectoryFileHeader_t) + header_->n_records * n_doubles * sizeof(double)) {
+    message = "the size of '" + path + "' does not match its " + std::to_string(header_->n_records) + " records";
+    return false;
+  }
+
+  if (!(header_->dt > 0)) {
+    message = "'" + path + "' has an invalid dt";
+    return false;
+  }
+
+  if (std::memchr(header_->frame_id, 0, sizeof(header_->frame_id)) == nullptr) {
+    message = "the frame id of '" + path + "' is not terminated";
+    return false;
+  }
+
+  return true;
+}
+
+//}
+
+/* size() //{ */
+
+inline int TrajectoryFile::size(void) const {
+
+  return int(header_->n_records);
+}
+
+//}
+
+/* dt() //{ */
+
+inline double TrajectoryFile::dt(void) const {
+
+  return header_->dt;
+}
+
+//}
+
+/* loop() //{ */
+
+inline bool TrajectoryFile::loop(void) const {
+
+  return header_->flags & TRAJECTORY_FILE_LOOP;
+}
+
+//}
+
+/* polynomial() //{ */
+
+inline bool TrajectoryFile::polynomial(void) const {
+
+  return header_->flags & TRAJECTORY_FILE_POLYNOMIAL;
+}
+
+//}
+
+/* stamped() //{ */
+
+inline bool TrajectoryFile::stamped(void) const {
+
+  return header_->flags & TRAJECTORY_FILE_STAMPED;
+}
+
+//}
+
+/* frameId() //{ */
+
+inline std::string TrajectoryFile::frameId(void) const {
+
+  return std::string(header_->frame_id);
+}
+
+//}
+
+/* recordLen() //{ */
+
+inline int TrajectoryFile::recordLen(void) const {
+
+  return polynomial() ? 1 + 4 * TRAJECTORY_FILE_N_COEFFS : 4;
+}
+
+//}
+
+/* records() //{ */
+
+inline const double* TrajectoryFile::records(void) const {
+
+  return reinterpret_cast<const double*>(static_cast<const char*>(data_) + sizeof(TrajectoryFileHeader_t));
+}
+
+//}
+
+/* stamps() //{ */
+
+inline const double* TrajectoryFile::stamps(void) const {
+
+  return records() + std::size_t(size()) * recordLen();
+}
+
+//}
+
+}  // namespace mpc_tracker
+
+}  // namespace mrs_uav_trackers
+
+#endif
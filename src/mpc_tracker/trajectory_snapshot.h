@@ -0,0 +1,568 @@
+#ifndef MPC_TRACKER_TRAJECTORY_SNAPSHOT_H
+#define MPC_TRACKER_TRAJECTORY_SNAPSHOT_H
+
+#include <eigen3/Eigen/Eigen>
+
+#include <mrs_msgs/Reference.h>
+
+#include <mrs_lib/geometry/cyclic.h>
+
+#include <memory>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "horizon.h"
+#include "trajectory_file.h"
+
+namespace mrs_uav_trackers
+{
+
+namespace mpc_tracker
+{
+
+/* struct HorizonStencil_t //{ */
+
+// how the samples of the prediction horizon lie on a trajectory
+// sample i lies between the points (idx + offset(i)) and (idx + offset(i) + 1), where idx is the current point, coeff(i) is the weight of the latter
+struct HorizonStencil_t {
+  Eigen::Matrix<int, Eigen::Dynamic, 1, 0, MPC_MAX_HORIZON_LEN, 1> offset;
+  mpc_horizon_t                                                    coeff;
+};
+
+//}
+
+/* struct TrajectorySnapshot_t //{ */
+
+// consecutive points of a trajectory, 4 doubles per point, [x, y, z, heading]
+// the block either owns the points or they lie in a mapped trajectory file, the pointer keeps the owner alive
+struct TrajectoryBlock_t {
+
+  std::shared_ptr<const double> data;
+  int                           cols = 0;  // number of points
+
+  Eigen::Map<const Eigen::Matrix<double, 4, Eigen::Dynamic>> points(void) const {
+    return Eigen::Map<const Eigen::Matrix<double, 4, Eigen::Dynamic>>(data.get(), 4, cols);
+  }
+};
+
+// allocates a block which owns its points, they have to be filled in through the returned matrix before the block is shared
+inline std::tuple<TrajectoryBlock_t, Eigen::Map<Eigen::Matrix<double, 4, Eigen::Dynamic>>> allocateTrajectoryBlock(const int cols) {
+
+  std::shared_ptr<double[]> data(new double[4 * cols]);
+
+  TrajectoryBlock_t block;
+  block.data = std::shared_ptr<const double>(data, data.get());
+  block.cols = cols;
+
+  return std::tuple(block, Eigen::Map<Eigen::Matrix<double, 4, Eigen::Dynamic>>(data.get(), 4, cols));
+}
+
+// finds the interval [times[k], times[k + 1]) which contains t, k is clamped to [0, n - 2], the n >= 2 times have to be increasing
+// the search starts at the hint and gallops towards t, so moving by a few intervals costs O(1) and a jump costs O(log(distance))
+inline int seekTime(const double* times, const int n, const double t, const int hint) {
+
+  const int last = n - 2;
+
+  int lo = std::clamp(hint, 0, last);
+  int hi;
+
+  if (times[lo] <= t) {
+
+    // times[lo] <= t, the answer is in [lo, hi)
+    int step = 1;
+
+    while (lo + step <= last && times[lo + step] <= t) {
+      lo += step;
+      step *= 2;
+    }
+
+    hi = std::min(lo + step, last + 1);
+
+  } else {
+
+    // times[hi] > t, the answer is in [lo, hi)
+    hi = lo;
+
+    int step = 1;
+
+    while (hi - step >= 0 && times[hi - step] > t) {
+      hi -= step;
+      step *= 2;
+    }
+
+    lo = std::max(hi - step, 0);
+  }
+
+  const int k = int(std::upper_bound(times + lo, times + hi, t) - times) - 1;
+
+  return std::clamp(k, 0, last);
+}
+
+// a trajectory given as a function of time, it is evaluated only where the tracker needs it
+struct TimedTrajectory_t {
+
+  virtual ~TimedTrajectory_t() = default;
+
+  virtual double duration(void) const = 0;
+
+  // evaluates [x, y, z, heading] at the time t from the start, the time is clamped to the trajectory
+  // cursor is a hint left by the previous evaluation, it is updated, so moving forward in time is cheap
+  virtual Eigen::Vector4d evaluate(double t, int& cursor) const = 0;
+};
+
+// a trajectory given by polynomial segments
+// every segment is its duration followed by the coefficients of x, y, z and heading, in the layout of the trajectory file
+struct TrajectorySegments_t : public TimedTrajectory_t {
+
+  static const int n_coeffs   = TRAJECTORY_FILE_N_COEFFS;
+  static const int record_len = 1 + 4 * n_coeffs;
+
+  std::shared_ptr<const double> data;
+  std::vector<double>           start_time;  // of every segment and the end of the last one [s]
+
+  int size(void) const {
+    return int(start_time.size()) - 1;
+  }
+
+  double duration(void) const override {
+    return start_time.back();
+  }
+
+  bool            setData(const std::shared_ptr<const double>& new_data, const int n_segments);
+  Eigen::Vector4d evaluate(double t, int& cursor) const override;
+};
+
+// computes the start times of the segments, returns false when a duration is not positive
+inline bool TrajectorySegments_t::setData(const std::shared_ptr<const double>& new_data, const int n_segments) {
+
+  data = new_data;
+
+  start_time.resize(n_segments + 1);
+  start_time[0] = 0;
+
+  for (int i = 0; i < n_segments; i++) {
+
+    const double segment_duration = data.get()[i * record_len];
+
+    if (!(segment_duration > 0)) {
+      return false;
+    }
+
+    start_time[i + 1] = start_time[i] + segment_duration;
+  }
+
+  return true;
+}
+
+inline Eigen::Vector4d TrajectorySegments_t::evaluate(double t, int& cursor) const {
+
+  t = std::clamp(t, 0.0, duration());
+
+  cursor = seekTime(start_time.data(), int(start_time.size()), t, cursor);
+
+  const double tau = t - start_time[cursor];
+
+  Eigen::Matrix<double, n_coeffs, 1> powers;
+
+  powers(0) = 1;
+
+  for (int i = 1; i < n_coeffs; i++) {
+    powers(i) = powers(i - 1) * tau;
+  }
+
+  // a column of coefficients per axis
+  const Eigen::Map<const Eigen::Matrix<double, n_coeffs, 4>> coeffs(data.get() + cursor * record_len + 1);
+
+  return coeffs.transpose() * powers;
+}
+
+// a trajectory of points with their own timestamps, the position is interpolated linearly between them
+struct TrajectoryStampedPoints_t : public TimedTrajectory_t {
+
+  std::shared_ptr<const double> points;  // 4 doubles per point, [x, y, z, heading]
+  std::shared_ptr<const double> stamps;  // increasing [s]
+  int                           size = 0;
+
+  double duration(void) const override {
+    return stamps.get()[size - 1] - stamps.get()[0];
+  }
+
+  Eigen::Vector4d evaluate(double t, int& cursor) const override;
+};
+
+inline Eigen::Vector4d TrajectoryStampedPoints_t::evaluate(double t, int& cursor) const {
+
+  if (size == 1) {
+    return Eigen::Map<const Eigen::Vector4d>(points.get());
+  }
+
+  t = std::clamp(t + stamps.get()[0], stamps.get()[0], stamps.get()[size - 1]);
+
+  cursor = seekTime(stamps.get(), size, t, cursor);
+
+  const Eigen::Map<const Eigen::Vector4d> first(points.get() + 4 * cursor);
+  const Eigen::Map<const Eigen::Vector4d> second(points.get() + 4 * (cursor + 1));
+
+  const double coeff = (t - stamps.get()[cursor]) / (stamps.get()[cursor + 1] - stamps.get()[cursor]);
+
+  Eigen::Vector4d point = (1 - coeff) * first + coeff * second;
+
+  point(3) = mrs_lib::geometry::sradians::interp(first(3), second(3), coeff);
+
+  return point;
+}
+
+// the transform of the stored points to the current frame of the odometry, it accumulates the odometry switches (switchOdometrySource())
+// the points are stored as they were loaded, so a mapped trajectory file is never copied, the transform is applied when a point is read
+struct TrajectoryFrame_t {
+
+  Eigen::Matrix2d rotation    = Eigen::Matrix2d::Identity();  // of the horizontal position
+  Eigen::Vector2d translation = Eigen::Vector2d::Zero();
+  Eigen::Vector2d shift       = Eigen::Vector2d::Zero();  // of the height and the heading
+
+  Eigen::Vector4d apply(const Eigen::Vector4d& point) const {
+
+    Eigen::Vector4d transformed;
+
+    transformed.head<2>() = rotation * point.head<2>() + translation;
+    transformed.tail<2>() = point.tail<2>() + shift;
+
+    return transformed;
+  }
+
+  // maps a point of the current frame back to the stored one
+  Eigen::Vector4d invert(const Eigen::Vector4d& point) const {
+
+    Eigen::Vector4d stored;
+
+    stored.head<2>() = rotation.transpose() * (point.head<2>() - translation);
+    stored.tail<2>() = point.tail<2>() - shift;
+
+    return stored;
+  }
+
+  // this transform followed by the next one
+  TrajectoryFrame_t then(const TrajectoryFrame_t& next) const {
+
+    TrajectoryFrame_t combined;
+
+    combined.rotation    = next.rotation * rotation;
+    combined.translation = next.rotation * translation + next.translation;
+    combined.shift       = shift + next.shift;
+
+    return combined;
+  }
+};
+
+// the whole trajectory reference
+// once published, the snapshot is never modified, any change produces a new snapshot
+// the points are stored in immutable blocks, a new snapshot shares the blocks it does not change with the old one, so splicing a trajectory
+// costs only the new points and a copy of the block pointers
+struct TrajectorySnapshot_t {
+
+  static const int block_len = 256;
+
+  std::vector<TrajectoryBlock_t> blocks;  // all blocks but the last one are full
+
+  // when set, the points are evaluated from the timed trajectory at the times i * dt and there are no blocks
+  std::shared_ptr<const TimedTrajectory_t> timed;
+
+  TrajectoryFrame_t frame;  // applied to the stored points by point(), the blocks and the timed trajectory are never transformed
+
+  int    size = 0;  // number of points
+  double dt   = 0;
+  bool   loop = false;
+
+  std::shared_ptr<const std::vector<HorizonStencil_t>> stencils;  // the stencil for every sub-sample index (MPC iteration) between two points
+
+  // cursor is the hint of a timed trajectory (see TimedTrajectory_t::evaluate()), it is updated, so reading the points in order is cheap
+  // the callers keep it between the calls, like resampleTrajectory() does
+  Eigen::Vector4d point(const int i, int& cursor) const {
+
+    if (timed) {
+      return frame.apply(timed->evaluate(i * dt, cursor));
+    }
+
+    return frame.apply(Eigen::Map<const Eigen::Vector4d>(blocks[i / block_len].data.get() + 4 * (i % block_len)));
+  }
+
+  // the point which was reached at the time along the trajectory
+  int index(const double time) const {
+    return std::clamp(int(std::floor(time / dt + 1e-9)), 0, size - 1);
+  }
+
+  void truncate(const int new_size);
+  void append(const std::vector<mrs_msgs::Reference>& points, const int first, const double* heading);
+  bool map(const std::shared_ptr<const TrajectoryFile>& file);
+};
+
+// keeps the first new_size points, the points are not copied, the block which is cut just shows fewer of them
+inline void TrajectorySnapshot_t::truncate(const int new_size) {
+
+  if (new_size >= size) {
+    return;
+  }
+
+  blocks.resize((new_size + block_len - 1) / block_len);
+
+  if (new_size % block_len != 0) {
+    blocks.back().cols = new_size % block_len;
+  }
+
+  size = new_size;
+}
+
+// appends the points of a message from the index first on, they are copied straight into the blocks
+// the last block is completed first (as a copy), then new blocks follow
+// when the heading is given, it replaces the one of the points
+// the points are in the current frame, they are stored mapped back by the frame of the snapshot
+inline void TrajectorySnapshot_t::append(const std::vector<mrs_msgs::Reference>& points, const int first, const double* heading) {
+
+  int appended = first;
+
+  while (appended < int(points.size())) {
+
+    const int in_last_block = size % block_len;
+    const int n             = std::min(block_len - in_last_block, int(points.size()) - appended);
+
+    auto [block, block_points] = allocateTrajectoryBlock(in_last_block + n);
+
+    if (in_last_block > 0) {
+      block_points.leftCols(in_last_block) = blocks.back().points().leftCols(in_last_block);
+    }
+
+    for (int i = 0; i < n; i++) {
+
+      const mrs_msgs::Reference& point = points[appended + i];
+
+      block_points.col(in_last_block + i) =
+          frame.invert(Eigen::Vector4d(point.position.x, point.position.y, point.position.z, heading ? *heading : point.heading));
+    }
+
+    if (in_last_block > 0) {
+      blocks.back() = block;
+    } else {
+      blocks.push_back(block);
+    }
+
+    appended += n;
+    size += n;
+  }
+}
+
+// points the blocks or the timed trajectory into a mapped trajectory file, the data keep the file mapped
+// nothing is read from a file of points, the durations of the segments and the stamps of the points are read to validate them
+// returns false when the file is invalid
+inline bool TrajectorySnapshot_t::map(const std::shared_ptr<const TrajectoryFile>& file) {
+
+  dt   = file->dt();
+  loop = file->loop();
+
+  if (file->polynomial() || file->stamped()) {
+
+    std::shared_ptr<TimedTrajectory_t> new_timed;
+
+    if (file->polynomial()) {
+
+      auto segments = std::make_shared<TrajectorySegments_t>();
+
+      if (!segments->setData(std::shared_ptr<const double>(file, file->records()), file->size())) {
+        return false;
+      }
+
+      new_timed = segments;
+
+    } else {
+
+      auto stamped = std::make_shared<TrajectoryStampedPoints_t>();
+
+      stamped->points = std::shared_ptr<const double>(file, file->records());
+      stamped->stamps = std::shared_ptr<const double>(file, file->stamps());
+      stamped->size   = file->size();
+
+      for (int i = 1; i < stamped->size; i++) {
+        if (!(stamped->stamps.get()[i] > stamped->stamps.get()[i - 1])) {
+          return false;
+        }
+      }
+
+      new_timed = stamped;
+    }
+
+    const double n_points = std::floor(new_timed->duration() / dt + 1e-9) + 1;
+
+    if (!(n_points <= INT32_MAX)) {
+      return false;
+    }
+
+    timed = new_timed;
+    size  = int(n_points);
+
+    return true;
+  }
+
+  const int n_blocks = (file->size() + block_len - 1) / block_len;
+
+  blocks.resize(n_blocks);
+
+  for (int i = 0; i < n_blocks; i++) {
+    blocks[i].data = std::shared_ptr<const double>(file, file->records() + 4 * i * block_len);
+    blocks[i].cols = std::min(block_len, file->size() - i * block_len);
+  }
+
+  size = file->size();
+
+  return true;
+}
+
+//}
+
+/* makeHorizonStencil() //{ */
+
+// where the samples of the horizon (at the times sample_time relative to the first one) lie on a trajectory, when the first sample is
+// time_offset after the current point
+inline HorizonStencil_t makeHorizonStencil(const std::vector<double>& sample_time, const double time_offset, const double trajectory_dt) {
+
+  const int horizon_len = int(sample_time.size());
+
+  HorizonStencil_t stencil;
+
+  stencil.offset.resize(horizon_len);
+  stencil.coeff.resize(horizon_len);
+
+  for (int i = 0; i < horizon_len; i++) {
+
+    const double first_time = sample_time[i] + time_offset;
+
+    stencil.offset(i) = int(std::floor(first_time / trajectory_dt));
+    stencil.coeff(i)  = std::fmod(first_time / trajectory_dt, 1.0);
+  }
+
+  return stencil;
+}
+
+//}
+
+/* resampleTrajectory() //{ */
+
+// interpolates the trajectory at the samples of the prediction horizon, time is the current time along the trajectory
+// a timed trajectory is evaluated at the exact times of the samples, cursor is the cursor in it
+// dt1 is the period of the MPC, the precomputed stencils of the trajectory are for its multiples
+inline void resampleTrajectory(const TrajectorySnapshot_t& trajectory, const std::vector<double>& sample_time, const double dt1, const double time, int& cursor,
+                               mpc_horizon_t& des_x, mpc_horizon_t& des_y, mpc_horizon_t& des_z, mpc_horizon_t& des_heading) {
+
+  const int horizon_len = int(sample_time.size());
+
+  if (trajectory.timed) {
+
+    des_x.resize(horizon_len);
+    des_y.resize(horizon_len);
+    des_z.resize(horizon_len);
+    des_heading.resize(horizon_len);
+
+    // past the end, the last point is held, a loop wraps after the last point like the sampled one
+    const double end_time  = (trajectory.size - 1) * trajectory.dt;
+    const double loop_time = trajectory.size * trajectory.dt;
+
+    // the cursor follows the first sample between the calls, the other samples move forward from it
+    int horizon_cursor = cursor;
+
+    for (int i = 0; i < horizon_len; i++) {
+
+      double t = time + sample_time[i];
+
+      t = trajectory.loop ? std::fmod(t, loop_time) : std::min(t, end_time);
+
+      const Eigen::Vector4d point = trajectory.frame.apply(trajectory.timed->evaluate(t, horizon_cursor));
+
+      if (i == 0) {
+        cursor = horizon_cursor;
+      }
+
+      des_x(i)       = point(0);
+      des_y(i)       = point(1);
+      des_z(i)       = point(2);
+      des_heading(i) = mrs_lib::geometry::sradians::wrap(point(3));
+    }
+
+    return;
+  }
+
+  // the current point and the number of the model steps since reaching it
+  const int    idx     = trajectory.index(time);
+  const double sub     = (time - idx * trajectory.dt) / dt1;
+  const int    sub_idx = int(std::round(sub));
+
+  // the stencils are precomputed for the steps of the model, a time off the steps (dt is not a multiple of dt1) falls back to computing it
+  HorizonStencil_t        off_grid_stencil;
+  const HorizonStencil_t* stencil;
+
+  if (std::abs(sub - sub_idx) < 1e-6 && sub_idx >= 0 && sub_idx < int(trajectory.stencils->size())) {
+    stencil = &(*trajectory.stencils)[sub_idx];
+  } else {
+    off_grid_stencil = makeHorizonStencil(sample_time, time - idx * trajectory.dt, trajectory.dt);
+    stencil          = &off_grid_stencil;
+  }
+
+  const int last_idx = trajectory.size - 1;
+
+  des_x.resize(horizon_len);
+  des_y.resize(horizon_len);
+  des_z.resize(horizon_len);
+  des_heading.resize(horizon_len);
+
+  const TrajectoryFrame_t& frame = trajectory.frame;
+
+  // the samples move forward through the points, a block is looked up only when they leave the previous one
+  int           block_first = 0;
+  int           block_end   = 0;
+  const double* block_data  = nullptr;
+
+  const auto stored = [&](const int point_idx) {
+    if (point_idx < block_first || point_idx >= block_end) {
+      const TrajectoryBlock_t& block = trajectory.blocks[point_idx / TrajectorySnapshot_t::block_len];
+      block_first                    = point_idx - point_idx % TrajectorySnapshot_t::block_len;
+      block_end                      = block_first + block.cols;
+      block_data                     = block.data.get();
+    }
+    return block_data + 4 * (point_idx - block_first);
+  };
+
+  for (int i = 0; i < horizon_len; i++) {
+
+    int first_idx  = idx + stencil->offset(i);
+    int second_idx = first_idx + 1;
+
+    if (trajectory.loop) {
+      first_idx %= trajectory.size;
+      second_idx %= trajectory.size;
+    } else {
+      first_idx  = std::min(first_idx, last_idx);
+      second_idx = std::min(second_idx, last_idx);
+    }
+
+    const double* first  = stored(first_idx);
+    const double* second = stored(second_idx);
+    const double  coeff  = stencil->coeff(i);
+
+    // the frame commutes with the blending, so it is applied to the blended point
+    const double x = (1 - coeff) * first[0] + coeff * second[0];
+    const double y = (1 - coeff) * first[1] + coeff * second[1];
+
+    des_x(i)       = frame.rotation(0, 0) * x + frame.rotation(0, 1) * y + frame.translation(0);
+    des_y(i)       = frame.rotation(1, 0) * x + frame.rotation(1, 1) * y + frame.translation(1);
+    des_z(i)       = (1 - coeff) * first[2] + coeff * second[2] + frame.shift(0);
+    des_heading(i) = mrs_lib::geometry::sradians::interp(first[3], second[3], coeff) + frame.shift(1);
+  }
+}
+
+//}
+
+}  // namespace mpc_tracker
+
+}  // namespace mrs_uav_trackers
+
+#endif
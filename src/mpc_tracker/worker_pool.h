@@ -0,0 +1,172 @@
+#ifndef MPC_TRACKER_WORKER_POOL_H
+#define MPC_TRACKER_WORKER_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+namespace mrs_uav_trackers
+{
+
+namespace mpc_tracker
+{
+
+/* class WorkerPool //{ */
+
+/**
+ * @brief A small pool of persistent threads which run a batch of tasks and wait for all of them (a barrier).
+ *
+ * The first task of a batch runs in the calling thread, the others are handed to the workers. Task i is always executed by the same thread,
+ * the tasks have to be independent of each other.
+ */
+class WorkerPool {
+
+public:
+  explicit WorkerPool(const int n_workers);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  void run(const std::function<void()>* tasks, const int n_tasks);
+
+private:
+  void worker(const int id);
+
+  std::vector<std::thread> threads_;
+
+  std::mutex              mutex_;
+  std::condition_variable cond_start_;
+  std::condition_variable cond_done_;
+
+  const std::function<void()>* tasks_      = nullptr;
+  int                          n_tasks_    = 0;
+  unsigned long                generation_ = 0;
+  int                          pending_    = 0;
+  bool                         stop_       = false;
+};
+
+//}
+
+/* WorkerPool() //{ */
+
+inline WorkerPool::WorkerPool(const int n_workers) {
+
+  for (int i = 0; i < n_workers; i++) {
+    threads_.emplace_back(&WorkerPool::worker, this, i);
+  }
+}
+
+//}
+
+/* ~WorkerPool() //{ */
+
+inline WorkerPool::~WorkerPool() {
+
+  {
+    std::scoped_lock lock(mutex_);
+
+    stop_ = true;
+  }
+
+  cond_start_.notify_all();
+
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+//}
+
+/* run() //{ */
+
+// runs the tasks and returns when all of them are finished
+inline void WorkerPool::run(const std::function<void()>* tasks, const int n_tasks) {
+
+  const int n_delegated = std::min(n_tasks - 1, int(threads_.size()));
+
+  if (n_delegated > 0) {
+
+    {
+      std::scoped_lock lock(mutex_);
+
+      tasks_   = tasks;
+      n_tasks_ = n_tasks;
+      pending_ = n_delegated;
+      generation_++;
+    }
+
+    cond_start_.notify_all();
+  }
+
+  // the calling thread takes the first task and the ones which did not fit into the pool
+  for (int i = 0; i < n_tasks; i++) {
+    if (i == 0 || i > n_delegated) {
+      tasks[i]();
+    }
+  }
+
+  if (n_delegated > 0) {
+
+    std::unique_lock lock(mutex_);
+
+    cond_done_.wait(lock, [this] { return pending_ == 0; });
+
+    tasks_   = nullptr;
+    n_tasks_ = 0;
+  }
+}
+
+//}
+
+/* worker() //{ */
+
+inline void WorkerPool::worker(const int id) {
+
+  unsigned long last_generation = 0;
+
+  while (true) {
+
+    const std::function<void()>* task = nullptr;
+
+    {
+      std::unique_lock lock(mutex_);
+
+      cond_start_.wait(lock, [&] { return stop_ || generation_ != last_generation; });
+
+      if (stop_) {
+        return;
+      }
+
+      last_generation = generation_;
+
+      if (id + 1 < n_tasks_) {
+        task = &tasks_[id + 1];
+      }
+    }
+
+    if (task == nullptr) {
+      continue;
+    }
+
+    (*task)();
+
+    {
+      std::scoped_lock lock(mutex_);
+
+      pending_--;
+    }
+
+    cond_done_.notify_one();
+  }
+}
+
+//}
+
+}  // namespace mpc_tracker
+
+}  // namespace mrs_uav_trackers
+
+#endif
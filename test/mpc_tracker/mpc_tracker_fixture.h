@@ -0,0 +1,177 @@
+#ifndef MPC_TRACKER_TEST_MPC_TRACKER_FIXTURE_H
+#define MPC_TRACKER_TEST_MPC_TRACKER_FIXTURE_H
+
+#include <gtest/gtest.h>
+
+#include <ros/ros.h>
+#include <pluginlib/class_loader.h>
+
+#include <mrs_uav_managers/tracker.h>
+
+#include <mrs_lib/transformer.h>
+
+#include <mrs_msgs/TrajectoryReferenceSrv.h>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace mrs_uav_trackers
+{
+
+namespace test
+{
+
+/* class MpcTrackerFixture //{ */
+
+/**
+ * @brief The MpcTracker loaded as a plugin and driven as the control manager drives it.
+ *
+ * The parameters are loaded by the .test file into the private namespace of the test node. The tracker is activated at a hover and
+ * update() can be called periodically by a thread which plays the control manager.
+ */
+class MpcTrackerFixture : public ::testing::Test {
+
+protected:
+  void SetUp() override {
+
+    nh_ = ros::NodeHandle("~");
+
+    spinner_ = std::make_unique<ros::AsyncSpinner>(2);
+    spinner_->start();
+
+    common_handlers_ = std::make_shared<mrs_uav_managers::CommonHandlers_t>();
+
+    common_handlers_->transformer                 = std::make_shared<mrs_lib::Transformer>("MpcTrackerTest", _uav_name_);
+    common_handlers_->safety_area.use_safety_area = false;
+    common_handlers_->safety_area.getMinHeight    = []() { return 0.5; };
+    common_handlers_->safety_area.getMaxHeight    = []() { return 100.0; };
+
+    tracker_ = loader_.createInstance("mrs_uav_trackers/MpcTracker");
+
+    tracker_->initialize(nh_, _uav_name_, common_handlers_);
+
+    mrs_msgs::DynamicsConstraintsSrvRequest::Ptr constraints(new mrs_msgs::DynamicsConstraintsSrvRequest());
+
+    mrs_msgs::DynamicsConstraints& c = constraints->constraints;
+
+    c.horizontal_speed                 = 2.0;
+    c.horizontal_acceleration          = 2.0;
+    c.horizontal_jerk                  = 20.0;
+    c.horizontal_snap                  = 20.0;
+    c.vertical_ascending_speed         = 2.0;
+    c.vertical_ascending_acceleration  = 2.0;
+    c.vertical_ascending_jerk          = 20.0;
+    c.vertical_ascending_snap          = 20.0;
+    c.vertical_descending_speed        = 2.0;
+    c.vertical_descending_acceleration = 2.0;
+    c.vertical_descending_jerk         = 20.0;
+    c.vertical_descending_snap         = 20.0;
+    c.heading_speed                    = 1.0;
+    c.heading_acceleration             = 2.0;
+    c.heading_jerk                     = 20.0;
+    c.heading_snap                     = 20.0;
+
+    tracker_->setConstraints(constraints);
+
+    // the tracker is activated from the current state
+    tracker_->update(uavState(), mrs_msgs::AttitudeCommand::ConstPtr());
+
+    auto [success, message] = tracker_->activate(mrs_msgs::PositionCommand::ConstPtr());
+
+    ASSERT_TRUE(success) << message;
+  }
+
+  void TearDown() override {
+
+    stopControlLoop();
+
+    if (tracker_) {
+      tracker_->deactivate();
+    }
+
+    spinner_->stop();
+  }
+
+  // the odometry of a UAV hovering at the given position
+  mrs_msgs::UavState::ConstPtr uavState(const double x = 0, const double y = 0, const double z = 2) {
+
+    mrs_msgs::UavState::Ptr uav_state(new mrs_msgs::UavState());
+
+    uav_state->header.stamp       = ros::Time::now();
+    uav_state->header.frame_id    = _uav_name_ + "/gps_origin";
+    uav_state->pose.position.x    = x;
+    uav_state->pose.position.y    = y;
+    uav_state->pose.position.z    = z;
+    uav_state->pose.orientation.w = 1;
+
+    return uav_state;
+  }
+
+  // a circle with the radius of 10 m flown at 0.5 m/s and sampled with dt, in the frame of the odometry, it starts at the origin
+  mrs_msgs::TrajectoryReference circle(const int n_points, const double phase = 0, const double dt = 0.2) {
+
+    mrs_msgs::TrajectoryReference trajectory;
+
+    trajectory.dt          = dt;
+    trajectory.use_heading = true;
+    trajectory.points.resize(n_points);
+
+    for (int i = 0; i < n_points; i++) {
+
+      const double angle = phase + 0.05 * i * dt;
+
+      trajectory.points[i].position.x = 10 * std::cos(angle) - 10;
+      trajectory.points[i].position.y = 10 * std::sin(angle);
+      trajectory.points[i].position.z = 2;
+      trajectory.points[i].heading    = angle;
+    }
+
+    return trajectory;
+  }
+
+  // calls update() at the rate of the control manager until stopControlLoop()
+  void startControlLoop(const double rate = 100.0) {
+
+    control_loop_running_ = true;
+
+    control_loop_ = std::thread([this, rate]() {
+      ros::Rate loop_rate(rate);
+
+      while (control_loop_running_ && ros::ok()) {
+        tracker_->update(uavState(), mrs_msgs::AttitudeCommand::ConstPtr());
+        loop_rate.sleep();
+      }
+    });
+  }
+
+  void stopControlLoop(void) {
+
+    control_loop_running_ = false;
+
+    if (control_loop_.joinable()) {
+      control_loop_.join();
+    }
+  }
+
+  const std::string _uav_name_ = "uav1";
+
+  ros::NodeHandle                    nh_;
+  std::unique_ptr<ros::AsyncSpinner> spinner_;
+
+  std::shared_ptr<mrs_uav_managers::CommonHandlers_t> common_handlers_;
+
+  pluginlib::ClassLoader<mrs_uav_managers::Tracker> loader_{"mrs_uav_managers", "mrs_uav_managers::Tracker"};
+  boost::shared_ptr<mrs_uav_managers::Tracker>      tracker_;
+
+  std::thread       control_loop_;
+  std::atomic<bool> control_loop_running_ = false;
+};
+
+//}
+
+}  // namespace test
+
+}  // namespace mrs_uav_trackers
+
+#endif
@@ -0,0 +1,149 @@
+#include "mpc_tracker_fixture.h"
+
+#include <pthread.h>
+
+#include <cerrno>
+#include <cstring>
+
+using namespace mrs_uav_trackers::test;
+
+/* counting the allocations //{ */
+
+// the allocator of the whole process is interposed, the allocations are counted while counting is set:
+// * all of them made by the calling thread
+// * those made by the MPC thread, which is told apart by its name
+namespace
+{
+
+std::atomic<bool> counting               = false;
+std::atomic<long> mpc_thread_allocations = 0;
+thread_local long thread_allocations     = 0;
+const char* const mpc_thread_name        = "mpc_loop";
+
+void countAllocation(void) {
+
+  if (!counting.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  thread_allocations++;
+
+  // for the calling thread, this is a prctl(), it does not allocate
+  char name[16];
+
+  if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 && std::strcmp(name, mpc_thread_name) == 0) {
+    mpc_thread_allocations++;
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+  countAllocation();
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+  countAllocation();
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  countAllocation();
+  return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+  countAllocation();
+  *ptr = __libc_memalign(alignment, size);
+  return *ptr ? 0 : ENOMEM;
+}
+}
+
+//}
+
+/* TEST_F(MpcTrackerFixture, HotPathDoesNotAllocate) //{ */
+
+// while a trajectory is tracked, the MPC iterations do not allocate at all and update() allocates only the command it returns
+// (the Tracker interface hands it over in a new shared pointer)
+// not covered: the debugging topics and the diagnostics, which are published by the timers of the tracker on the spinner threads,
+// and the services which load the trajectories
+TEST_F(MpcTrackerFixture, HotPathDoesNotAllocate) {
+
+  mrs_msgs::TrajectoryReferenceSrvRequest::Ptr load(new mrs_msgs::TrajectoryReferenceSrvRequest());
+
+  load->trajectory         = circle(10000);
+  load->trajectory.fly_now = true;
+
+  const auto load_response = tracker_->setTrajectoryReference(load);
+
+  ASSERT_TRUE(load_response->success) << load_response->message;
+
+  // the tracker is driven from this thread, so the allocations of update() are counted by thread_allocations
+  auto run = [&](const double duration) {
+    long max_update_allocations = 0;
+
+    const ros::WallTime end = ros::WallTime::now() + ros::WallDuration(duration);
+
+    ros::WallRate rate(100.0);
+
+    mrs_msgs::PositionCommand::ConstPtr command;
+
+    while (ros::WallTime::now() < end) {
+
+      const auto uav_state = uavState();
+
+      const long before = thread_allocations;
+
+      command = tracker_->update(uav_state, mrs_msgs::AttitudeCommand::ConstPtr());
+
+      max_update_allocations = std::max(max_update_allocations, thread_allocations - before);
+
+      rate.sleep();
+    }
+
+    return std::tuple(max_update_allocations, command);
+  };
+
+  // the first iterations initialize the logging and the caches
+  run(2.0);
+
+  mpc_thread_allocations = 0;
+  counting               = true;
+
+  auto [max_update_allocations, command] = run(3.0);
+
+  // what returning the command costs at least
+  const long before = thread_allocations;
+
+  const mrs_msgs::PositionCommand::ConstPtr copy(new mrs_msgs::PositionCommand(*command));
+
+  const long command_allocations = thread_allocations - before;
+
+  counting = false;
+
+  ASSERT_TRUE(command);
+
+  EXPECT_EQ(mpc_thread_allocations, 0);
+  EXPECT_LE(max_update_allocations, command_allocations);
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  ros::init(argc, argv, "test_mpc_tracker_allocations");
+
+  ros::NodeHandle nh;
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+#include "mpc_tracker_fixture.h"
+
+#include <std_msgs/Float64MultiArray.h>
+
+#include <mutex>
+
+using namespace mrs_uav_trackers::test;
+
+/* TEST_F(MpcTrackerFixture, UploadDoesNotDelayTicks) //{ */
+
+// a trajectory of 100k points is loaded and another 100k points are spliced to it while it is tracked,
+// the MPC thread has to keep its deadlines all the time, its wake up latencies are read from mpc_loop_jitter_out
+// an iteration blocked by the upload is longer but does not wake up later, so its longest iteration is compared with the one at the hover
+TEST_F(MpcTrackerFixture, UploadDoesNotDelayTicks) {
+
+  const int    n_points = 100000;
+  const double period   = 0.01;    // 1 / mpc_rate
+  const double margin   = 0.0005;  // [s] of the longest iteration over the one at the hover
+
+  std::mutex                               mutex_jitter;
+  std::vector<std_msgs::Float64MultiArray> jitter;
+
+  ros::Subscriber subscriber = nh_.subscribe<std_msgs::Float64MultiArray>("mpc_tracker/mpc_loop_jitter_out", 100,
+                                                                          [&](const std_msgs::Float64MultiArray::ConstPtr& msg) {
+                                                                            std::scoped_lock lock(mutex_jitter);
+                                                                            jitter.push_back(*msg);
+                                                                          });
+
+  startControlLoop();
+
+  // [number of iterations, mean, std. dev., min, max wake up latency [us], longest iteration [us], number of overruns]
+  auto longestIteration = [&](void) {
+    std::scoped_lock lock(mutex_jitter);
+
+    double max_runtime = 0;
+
+    for (const auto& msg : jitter) {
+      max_runtime = std::max(max_runtime, msg.data[5] * 1e-6);
+    }
+
+    return max_runtime;
+  };
+
+  // the MPC settles at the hover
+  ros::Duration(2.0).sleep();
+
+  {
+    std::scoped_lock lock(mutex_jitter);
+    jitter.clear();
+  }
+
+  // the longest iteration without the upload
+  ros::Duration(2.0).sleep();
+
+  const double hover_max_runtime = longestIteration();
+
+  ASSERT_GT(hover_max_runtime, 0);
+
+  {
+    std::scoped_lock lock(mutex_jitter);
+    jitter.clear();
+  }
+
+  mrs_msgs::TrajectoryReferenceSrvRequest::Ptr load(new mrs_msgs::TrajectoryReferenceSrvRequest());
+
+  load->trajectory         = circle(n_points);
+  load->trajectory.fly_now = true;
+
+  const auto load_response = tracker_->setTrajectoryReference(load);
+
+  ASSERT_TRUE(load_response->success) << load_response->message;
+
+  ros::ServiceClient splice_client = nh_.serviceClient<mrs_msgs::TrajectoryReferenceSrv>("mpc_tracker/trajectory_splice_in");
+
+  mrs_msgs::TrajectoryReferenceSrv splice;
+  splice.request.trajectory = circle(n_points, 0.01 * n_points);
+
+  ASSERT_TRUE(splice_client.call(splice));
+  ASSERT_TRUE(splice.response.success) << splice.response.message;
+
+  // the statistics of the last iterations are published
+  ros::Duration(0.5).sleep();
+
+  stopControlLoop();
+
+  const double upload_max_runtime = longestIteration();
+
+  std::scoped_lock lock(mutex_jitter);
+
+  double n_iterations = 0;
+  double n_overruns   = 0;
+  double max_latency  = 0;
+
+  for (const auto& msg : jitter) {
+    n_iterations += msg.data[0];
+    n_overruns += msg.data[6];
+    max_latency = std::max(max_latency, msg.data[4] * 1e-6);
+  }
+
+  EXPECT_GT(n_iterations, 0);
+  EXPECT_EQ(n_overruns, 0);
+  EXPECT_LT(max_latency, period);
+  EXPECT_LT(upload_max_runtime, hover_max_runtime + margin);
+}
+
+//}
+
+/* TEST_F(MpcTrackerFixture, TrajectoryFinerThanMpcPeriod) //{ */
+
+// a trajectory sampled more finely than the MPC period (1 / mpc_rate = 0.01 s) is accepted and tracked
+TEST_F(MpcTrackerFixture, TrajectoryFinerThanMpcPeriod) {
+
+  const double dt       = 0.002;
+  const double duration = 10.0;
+
+  startControlLoop();
+
+  ros::Duration(1.0).sleep();
+
+  mrs_msgs::TrajectoryReferenceSrvRequest::Ptr load(new mrs_msgs::TrajectoryReferenceSrvRequest());
+
+  load->trajectory         = circle(int(duration / dt) + 1, 0, dt);
+  load->trajectory.fly_now = true;
+
+  const auto load_response = tracker_->setTrajectoryReference(load);
+
+  ASSERT_TRUE(load_response->success) << load_response->message;
+
+  const ros::Time start = ros::Time::now();
+
+  ros::Duration(2.0).sleep();
+
+  stopControlLoop();
+
+  const auto   command = tracker_->update(uavState(), mrs_msgs::AttitudeCommand::ConstPtr());
+  const double angle   = 0.05 * (ros::Time::now() - start).toSec();
+
+  ASSERT_TRUE(command);
+
+  // 1 m along the circle, the command lags behind it by the MPC's tracking error only
+  EXPECT_NEAR(command->position.x, 10 * std::cos(angle) - 10, 0.2);
+  EXPECT_NEAR(command->position.y, 10 * std::sin(angle), 0.2);
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  ros::init(argc, argv, "test_mpc_tracker_upload");
+
+  ros::NodeHandle nh;
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,154 @@
+#ifndef MPC_TRACKER_TEST_CLOSED_LOOP_H
+#define MPC_TRACKER_TEST_CLOSED_LOOP_H
+
+#include <eigen3/Eigen/Eigen>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace mrs_uav_trackers
+{
+
+namespace test
+{
+
+/* ClosedLoopParams_t //{ */
+
+// a step of the reference of a single axis flown in closed loop with the solver, as the MpcTracker does it
+struct ClosedLoopParams_t
+{
+  double dt1         = 0.01;  // the period of the solves, also the length of the first step of the horizon
+  double dt2         = 0.2;   // the length of the other steps
+  int    horizon_len = 40;
+  int    n_steps     = 1500;
+
+  double goal = 10.0;
+
+  double max_speed = 2.0;
+  double max_acc   = 2.0;
+  double max_jerk  = 20.0;
+  double max_snap  = 20.0;
+};
+
+//}
+
+/* ClosedLoopResult_t //{ */
+
+struct ClosedLoopResult_t
+{
+  double final_position = 0;
+  double final_speed    = 0;
+
+  double max_speed = 0;
+  double max_acc   = 0;
+  double max_jerk  = 0;
+
+  // the largest violation of the limits by the predicted states and the first input over all the solves
+  double max_predicted_violation = 0;
+
+  double mean_solve_time = 0;  // [s]
+  double max_solve_time  = 0;  // [s]
+
+  // the state of the virtual UAV after each step and the first input of each solve, before it is saturated
+  std::vector<Eigen::Vector4d> states;
+  std::vector<double>          inputs;
+};
+
+//}
+
+/* runClosedLoop() //{ */
+
+/**
+ * @brief flies a step of the reference with the solver in closed loop with the model of the virtual UAV
+ *
+ * The reference is filtered by the speed limit and the velocity weight is raised when braking, as the MpcTracker does it.
+ * Works with any solver which has the interface of the MpcTracker's solver.
+ */
+template <typename SolverT>
+ClosedLoopResult_t runClosedLoop(SolverT& solver, const ClosedLoopParams_t& params) {
+
+  const int    N   = params.horizon_len;
+  const double dt1 = params.dt1;
+
+  Eigen::MatrixXd x         = Eigen::MatrixXd::Zero(4, 1);
+  Eigen::MatrixXd reference = Eigen::MatrixXd::Zero(N, 1);
+  Eigen::MatrixXd predicted = Eigen::MatrixXd::Zero(N * 3 * 4, 1);
+
+  Eigen::Matrix4d A;
+  A << 1, dt1, 0.5 * dt1 * dt1, 0, 0, 1, dt1, 0.5 * dt1 * dt1, 0, 0, 1, dt1, 0, 0, 0, 1;
+  const Eigen::Vector4d B(0, 0, 0, dt1);
+
+  const double limits[] = {params.max_speed, params.max_acc, params.max_jerk};
+
+  ClosedLoopResult_t result;
+
+  double solve_time = 0;
+
+  result.states.reserve(params.n_steps);
+  result.inputs.reserve(params.n_steps);
+
+  for (int t = 0; t < params.n_steps; t++) {
+
+    for (int i = 0; i < N; i++) {
+
+      const double max_step = params.max_speed * (i == 0 ? dt1 : params.dt2);
+      const double previous = i == 0 ? x(0) : reference(i - 1);
+
+      reference(i) = previous + std::clamp(params.goal - previous, -max_step, max_step);
+    }
+
+    const bool braking = std::abs(reference(8) - reference(N - 1)) < 0.1 && std::abs(reference(30) - reference(N - 1)) < 0.1;
+
+    solver.setVelQ(braking ? 2000 : 0);
+    solver.setInitialState(x);
+    solver.loadReference(reference);
+    solver.setLimits(params.max_speed, params.max_speed, params.max_acc, params.max_acc, params.max_jerk, params.max_jerk, params.max_snap,
+                     params.max_snap);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    solver.solveMPC();
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    solve_time += elapsed;
+    result.max_solve_time = std::max(result.max_solve_time, elapsed);
+
+    solver.getStates(predicted);
+
+    const double u = solver.getFirstControlInput();
+
+    for (int k = 0; k < N; k++) {
+      for (int j = 1; j < 4; j++) {
+        result.max_predicted_violation = std::max(result.max_predicted_violation, std::abs(predicted(k * 3 * 4 + j)) - limits[j - 1]);
+      }
+    }
+
+    result.max_predicted_violation = std::max(result.max_predicted_violation, std::abs(u) - params.max_snap);
+
+    x = A * x + B * std::clamp(u, -params.max_snap, params.max_snap);
+
+    result.states.push_back(x);
+    result.inputs.push_back(u);
+
+    result.max_speed = std::max(result.max_speed, std::abs(x(1)));
+    result.max_acc   = std::max(result.max_acc, std::abs(x(2)));
+    result.max_jerk  = std::max(result.max_jerk, std::abs(x(3)));
+  }
+
+  result.final_position  = x(0);
+  result.final_speed     = x(1);
+  result.mean_solve_time = solve_time / params.n_steps;
+
+  return result;
+}
+
+//}
+
+}  // namespace test
+
+}  // namespace mrs_uav_trackers
+
+#endif
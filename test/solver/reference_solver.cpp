@@ -0,0 +1,63 @@
+#include "reference_solver.h"
+
+#include <string>
+#include <vector>
+
+/* the prebuilt solver //{ */
+
+// the interface of the prebuilt library, as it was declared by include/mpc_tracker_solver.h before the in-tree solver replaced it,
+// it lives in its own translation unit since the in-tree solver reuses the name
+namespace mrs_mpc_solvers
+{
+
+namespace mpc_tracker
+{
+
+class Solver {
+
+public:
+  Solver(std::string name, bool verbose, int max_iters, std::vector<double> tempQ, double dt, double dt2, int dim);
+
+  void   setInitialState(Eigen::MatrixXd &x);
+  bool   setVelQ(double Q_vel);
+  bool   setQ(std::vector<double> Qnew);
+  void   loadReference(Eigen::MatrixXd &reference);
+  void   setLimits(double max_speed, double min_speed, double max_acc, double min_acc, double max_jerk, double min_jerk, double max_snap, double min_snap);
+  int    solveMPC();
+  void   getStates(Eigen::MatrixXd &future_traj);
+  double getFirstControlInput();
+
+private:
+  static const int _horizon_len_ = 40;
+  int              _dim_;
+  std::string      _name_;
+
+  std::vector<double> myQ_;
+};
+
+}  // namespace mpc_tracker
+
+}  // namespace mrs_mpc_solvers
+
+//}
+
+namespace mrs_uav_trackers
+{
+
+namespace test
+{
+
+/* runClosedLoopReference() //{ */
+
+ClosedLoopResult_t runClosedLoopReference(const ClosedLoopParams_t& params, const int max_iters) {
+
+  mrs_mpc_solvers::mpc_tracker::Solver solver("MpcTrackerReference", false, max_iters, {5000, 0, 0, 0}, params.dt1, params.dt2, 0);
+
+  return runClosedLoop(solver, params);
+}
+
+//}
+
+}  // namespace test
+
+}  // namespace mrs_uav_trackers
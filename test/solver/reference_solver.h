@@ -0,0 +1,20 @@
+#ifndef MPC_TRACKER_TEST_REFERENCE_SOLVER_H
+#define MPC_TRACKER_TEST_REFERENCE_SOLVER_H
+
+#include "closed_loop.h"
+
+namespace mrs_uav_trackers
+{
+
+namespace test
+{
+
+// flies the step with the prebuilt libMpcTrackerSolver.so, which the in-tree solver replaced
+// (it has a fixed horizon of 40 steps and its own iteration limit)
+ClosedLoopResult_t runClosedLoopReference(const ClosedLoopParams_t& params, const int max_iters);
+
+}  // namespace test
+
+}  // namespace mrs_uav_trackers
+
+#endif
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <mpc_tracker_solver.h>
+
+#include "closed_loop.h"
+
+using namespace mrs_uav_trackers::test;
+
+typedef mrs_mpc_solvers::mpc_tracker::Solver Solver;
+
+/* makeSolver() //{ */
+
+std::shared_ptr<Solver> makeSolver(const ClosedLoopParams_t& params, const int max_iters) {
+
+  std::vector<double> dts(params.horizon_len, params.dt2);
+  dts[0] = params.dt1;
+
+  return std::make_shared<Solver>("MpcTrackerTest", false, max_iters, std::vector<double>{5000, 0, 0, 0}, dts, 0);
+}
+
+//}
+
+/* TEST(Solver, StepWithinLimits) //{ */
+
+// the step of the reference is flown within the limits with the iteration limit of the default config
+TEST(Solver, StepWithinLimits) {
+
+  const std::vector<std::array<double, 4>> limit_sets = {{2.0, 2.0, 20.0, 20.0}, {1.0, 1.0, 10.0, 10.0}, {5.0, 3.0, 30.0, 40.0}};
+
+  for (const auto& limits : limit_sets) {
+
+    ClosedLoopParams_t params;
+    params.max_speed = limits[0];
+    params.max_acc   = limits[1];
+    params.max_jerk  = limits[2];
+    params.max_snap  = limits[3];
+
+    auto solver = makeSolver(params, 25);
+
+    const ClosedLoopResult_t result = runClosedLoop(*solver, params);
+
+    SCOPED_TRACE("limits " + std::to_string(limits[0]) + " " + std::to_string(limits[1]));
+
+    EXPECT_NEAR(result.final_position, params.goal, 1e-2);
+    EXPECT_NEAR(result.final_speed, 0.0, 1e-2);
+
+    // the virtual UAV integrates the first input over the first step, which overshoots the limits only by the discretization
+    EXPECT_LE(result.max_speed, 1.01 * params.max_speed);
+    EXPECT_LE(result.max_acc, 1.01 * params.max_acc);
+    EXPECT_LE(result.max_jerk, 1.01 * params.max_jerk);
+
+    EXPECT_LE(result.max_predicted_violation, 1e-9);
+  }
+}
+
+//}
+
+/* TEST(Solver, CutShortWithinLimits) //{ */
+
+// the returned states and input keep the limits even when the solve is stopped after the first iteration
+TEST(Solver, CutShortWithinLimits) {
+
+  ClosedLoopParams_t params;
+  params.n_steps = 300;
+
+  auto solver = makeSolver(params, 1);
+
+  const ClosedLoopResult_t result = runClosedLoop(*solver, params);
+
+  EXPECT_LE(result.max_predicted_violation, 1e-9);
+}
+
+//}
+
+/* TEST(Solver, SteadyStateHold) //{ */
+
+// the hold is returned only when the initial state integrated with zero input stays at the reference, and never right after the limits changed
+TEST(Solver, SteadyStateHold) {
+
+  ClosedLoopParams_t params;
+
+  auto solver = makeSolver(params, 200);
+  solver->setSteadyStateTolerance(1e-4);
+
+  Eigen::MatrixXd x         = Eigen::MatrixXd::Zero(4, 1);
+  Eigen::MatrixXd reference = Eigen::MatrixXd::Constant(params.horizon_len, 1, 1.0);
+  Eigen::MatrixXd predicted = Eigen::MatrixXd::Zero(params.horizon_len * 3 * 4, 1);
+
+  x(0) = 1.0;
+
+  auto solve = [&]() {
+    solver->setInitialState(x);
+    solver->loadReference(reference);
+    solver->setLimits(params.max_speed, params.max_speed, params.max_acc, params.max_acc, params.max_jerk, params.max_jerk, params.max_snap,
+                      params.max_snap);
+    solver->solveMPC();
+    return solver->getStatus();
+  };
+
+  // the first solve sets the limits, so it iterates
+  EXPECT_NE(solve(), mrs_mpc_solvers::mpc_tracker::SOLVER_STEADY_STATE);
+  EXPECT_EQ(solve(), mrs_mpc_solvers::mpc_tracker::SOLVER_STEADY_STATE);
+
+  solver->getStates(predicted);
+
+  for (int k = 0; k < params.horizon_len; k++) {
+    EXPECT_DOUBLE_EQ(predicted(k * 3 * 4), 1.0);
+    EXPECT_DOUBLE_EQ(predicted(k * 3 * 4 + 1), 0.0);
+  }
+
+  EXPECT_DOUBLE_EQ(solver->getFirstControlInput(), 0.0);
+
+  // within the tolerance at the start, but it drifts away over the horizon
+  x(1) = 5e-5;
+
+  EXPECT_NE(solve(), mrs_mpc_solvers::mpc_tracker::SOLVER_STEADY_STATE);
+
+  x(1) = 0;
+
+  EXPECT_EQ(solve(), mrs_mpc_solvers::mpc_tracker::SOLVER_STEADY_STATE);
+
+  // new limits are solved for once
+  params.max_speed = 1.0;
+
+  EXPECT_NE(solve(), mrs_mpc_solvers::mpc_tracker::SOLVER_STEADY_STATE);
+  EXPECT_EQ(solve(), mrs_mpc_solvers::mpc_tracker::SOLVER_STEADY_STATE);
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <mpc_tracker_solver.h>
+
+#include "reference_solver.h"
+
+using namespace mrs_uav_trackers::test;
+
+typedef mrs_mpc_solvers::mpc_tracker::Solver Solver;
+
+/* TEST(SolverReference, StepMatchesReference) //{ */
+
+// the in-tree solver flies the step as the prebuilt one, both with the iteration limit of the default config
+//
+// the closed loop states are compared sample by sample, the tolerances are relative to the limits:
+//   position 0.1 m, velocity 5 %, acceleration 30 %, jerk 25 %
+// the first input (snap) switches between its limits and the two solvers switch it at instants which differ by a step or two, a single
+// sample may then differ by twice the limit, so the input of each sample is compared with 5 % of the limit and at least 70 % of the samples
+// have to be within it, the rest is bounded by the jerk, which integrates the input
+TEST(SolverReference, StepMatchesReference) {
+
+  const int max_iters = 25;
+
+  const std::vector<std::array<double, 4>> limit_sets = {{2.0, 2.0, 20.0, 20.0}, {1.0, 1.0, 10.0, 10.0}, {5.0, 3.0, 30.0, 40.0}};
+
+  for (const auto& limits : limit_sets) {
+
+    ClosedLoopParams_t params;
+    params.max_speed = limits[0];
+    params.max_acc   = limits[1];
+    params.max_jerk  = limits[2];
+    params.max_snap  = limits[3];
+
+    std::vector<double> dts(params.horizon_len, params.dt2);
+    dts[0] = params.dt1;
+
+    Solver solver("MpcTrackerTest", false, max_iters, {5000, 0, 0, 0}, dts, 0);
+
+    const ClosedLoopResult_t result    = runClosedLoop(solver, params);
+    const ClosedLoopResult_t reference = runClosedLoopReference(params, max_iters);
+
+    SCOPED_TRACE("limits " + std::to_string(limits[0]) + " " + std::to_string(limits[1]));
+
+    ASSERT_EQ(result.states.size(), reference.states.size());
+
+    const Eigen::Vector4d tolerance(0.1, 0.05 * params.max_speed, 0.3 * params.max_acc, 0.25 * params.max_jerk);
+
+    int n_inputs_within = 0;
+
+    for (size_t t = 0; t < result.states.size(); t++) {
+
+      for (int j = 0; j < 4; j++) {
+        ASSERT_NEAR(result.states[t](j), reference.states[t](j), tolerance(j)) << "state " << j << " at step " << t;
+      }
+
+      const double input           = std::clamp(result.inputs[t], -params.max_snap, params.max_snap);
+      const double reference_input = std::clamp(reference.inputs[t], -params.max_snap, params.max_snap);
+
+      if (std::abs(input - reference_input) <= 0.05 * params.max_snap) {
+        n_inputs_within++;
+      }
+    }
+
+    EXPECT_GE(n_inputs_within, 0.7 * result.inputs.size());
+  }
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "../../src/mpc_tracker/trajectory_snapshot.h"
+
+using namespace mrs_uav_trackers::mpc_tracker;
+
+/* makeRamp() //{ */
+
+// a trajectory flying along x with the constant speed, sampled with dt, its stencils are made as the MpcTracker makes them
+std::shared_ptr<TrajectorySnapshot_t> makeRamp(const double dt, const double duration, const double speed, const std::vector<double>& sample_time,
+                                               const double dt1) {
+
+  std::vector<mrs_msgs::Reference> points(int(std::round(duration / dt)) + 1);
+
+  for (size_t i = 0; i < points.size(); i++) {
+    points[i].position.x = speed * i * dt;
+    points[i].position.z = 2.0;
+  }
+
+  auto trajectory = std::make_shared<TrajectorySnapshot_t>();
+
+  trajectory->dt = dt;
+  trajectory->append(points, 0, nullptr);
+
+  auto stencils = std::make_shared<std::vector<HorizonStencil_t>>();
+
+  for (int i = 0; i < int(std::ceil(dt / dt1)) + 1; i++) {
+    stencils->push_back(makeHorizonStencil(sample_time, i * dt1, dt));
+  }
+
+  trajectory->stencils = stencils;
+
+  return trajectory;
+}
+
+//}
+
+/* TEST(TrajectorySnapshot, ResampleAnyDt) //{ */
+
+// the horizon is resampled at the exact times of its samples for any dt of the trajectory, also for the ones finer than the MPC period
+TEST(TrajectorySnapshot, ResampleAnyDt) {
+
+  const double dt1         = 0.01;
+  const double dt2         = 0.2;
+  const int    horizon_len = 40;
+  const double speed       = 1.5;
+  const double duration    = 20.0;
+
+  std::vector<double> sample_time(horizon_len);
+
+  for (int i = 0; i < horizon_len; i++) {
+    sample_time[i] = i == 0 ? dt1 : sample_time[i - 1] + dt2;
+  }
+
+  for (const double dt : {0.002, 0.005, 0.01, 0.03, 0.2}) {
+
+    SCOPED_TRACE("dt " + std::to_string(dt));
+
+    auto trajectory = makeRamp(dt, duration, speed, sample_time, dt1);
+
+    mpc_horizon_t des_x, des_y, des_z, des_heading;
+
+    int cursor = 0;
+
+    // the MPC iterations over the part of the trajectory whose whole horizon lies on it
+    for (int k = 0; k * dt1 + sample_time.back() <= duration; k++) {
+
+      const double time = k * dt1;
+
+      resampleTrajectory(*trajectory, sample_time, dt1, time, cursor, des_x, des_y, des_z, des_heading);
+
+      ASSERT_EQ(des_x.size(), horizon_len);
+
+      for (int i = 0; i < horizon_len; i++) {
+        ASSERT_NEAR(des_x(i), speed * (time + sample_time[i]), 1e-9) << "sample " << i << " at " << time << " s";
+        ASSERT_NEAR(des_z(i), 2.0, 1e-9);
+      }
+    }
+  }
+}
+
+//}
+
+int main(int argc, char** argv) {
+
+  testing::InitGoogleTest(&argc, argv);
+
+  return RUN_ALL_TESTS();
+}